@@ -32,17 +32,25 @@ static void server_action_toggle_control(struct ptychite_server *server, void *d
 	}
 }
 
+static void server_action_toggle_hud(struct ptychite_server *server, void *data) {
+	ptychite_hud_toggle(&server->hud);
+}
+
+static void server_action_toggle_hud_damage(struct ptychite_server *server, void *data) {
+	ptychite_hud_toggle_damage(&server->hud);
+}
+
 static void server_action_spawn(struct ptychite_server *server, void *data) {
 	char **args = data;
 
-	ptychite_spawn(args);
+	ptychite_server_spawn(server, args);
 }
 
 static void server_action_shell(struct ptychite_server *server, void *data) {
 	char *command = data;
 	char *args[] = {"/bin/sh", "-c", command, NULL};
 
-	ptychite_spawn(args);
+	ptychite_server_spawn(server, args);
 }
 
 static void server_action_inc_master(struct ptychite_server *server, void *data) {
@@ -61,6 +69,14 @@ static void server_action_dec_mfact(struct ptychite_server *server, void *data)
 	ptychite_server_tiling_change_master_factor(server, -0.05);
 }
 
+static void server_action_next_layout(struct ptychite_server *server, void *data) {
+	ptychite_server_switch_keyboard_layout(server, 1);
+}
+
+static void server_action_prev_layout(struct ptychite_server *server, void *data) {
+	ptychite_server_switch_keyboard_layout(server, -1);
+}
+
 static void server_action_toggle_rmaster(struct ptychite_server *server, void *data) {
 	struct ptychite_monitor *monitor = server->active_monitor;
 	if (!monitor) {
@@ -68,7 +84,7 @@ static void server_action_toggle_rmaster(struct ptychite_server *server, void *d
 	}
 
 	struct ptychite_workspace *workspace = monitor->current_workspace;
-	workspace->tiling.traditional.right_master = !workspace->tiling.traditional.right_master;
+	workspace->tiling.params.traditional.right_master = !workspace->tiling.params.traditional.right_master;
 
 	ptychite_monitor_tile(monitor);
 }
@@ -206,6 +222,10 @@ static const struct {
 		{"swap_front", server_action_swap_front, PTYCHITE_ACTION_FUNC_DATA_NONE},
 		{"switch_app", server_action_switch_app, PTYCHITE_ACTION_FUNC_DATA_NONE},
 		{"switch_app_instance", server_action_switch_app_instance, PTYCHITE_ACTION_FUNC_DATA_NONE},
+		{"next_layout", server_action_next_layout, PTYCHITE_ACTION_FUNC_DATA_NONE},
+		{"prev_layout", server_action_prev_layout, PTYCHITE_ACTION_FUNC_DATA_NONE},
+		{"hud", server_action_toggle_hud, PTYCHITE_ACTION_FUNC_DATA_NONE},
+		{"hud_damage", server_action_toggle_hud_damage, PTYCHITE_ACTION_FUNC_DATA_NONE},
 };
 
 void ptychite_server_execute_action(struct ptychite_server *server, struct ptychite_action *action) {
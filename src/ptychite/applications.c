@@ -1,4 +1,5 @@
 #define _POSIX_C_SOURCE 200809L
+#include <ctype.h>
 #include <dirent.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -12,6 +13,7 @@
 #include "icon.h"
 #include "server.h"
 #include "util.h"
+#include "view.h"
 
 static void destroy_application(struct ptychite_application *app) {
 	free(app->name);
@@ -190,6 +192,56 @@ static void read_applications(struct ptychite_server *server) {
 	closedir(dir);
 }
 
+static struct ptychite_application *lookup_application_folded(struct ptychite_server *server, const char *name) {
+	struct ptychite_application *app = ptychite_hash_map_get(&server->applications, name);
+	if (app) {
+		return app;
+	}
+
+	char folded[256];
+	size_t i;
+	for (i = 0; name[i] && i < sizeof(folded) - 1; i++) {
+		folded[i] = tolower((unsigned char)name[i]);
+	}
+	if (name[i]) {
+		return NULL;
+	}
+	folded[i] = '\0';
+
+	if (!strcmp(folded, name)) {
+		return NULL;
+	}
+
+	return ptychite_hash_map_get(&server->applications, folded);
+}
+
+struct ptychite_application *ptychite_server_lookup_application(struct ptychite_server *server, const char *app_id) {
+	if (!app_id || !*app_id) {
+		return NULL;
+	}
+
+	/* desktop file basenames and StartupWMClass values are both keys of the map */
+	struct ptychite_application *app = lookup_application_folded(server, app_id);
+	if (app) {
+		return app;
+	}
+
+	/* reverse-DNS ids such as "org.gnome.Nautilus" often ship as "nautilus.desktop" */
+	const char *tail = strrchr(app_id, '.');
+	if (tail && tail[1]) {
+		return lookup_application_folded(server, tail + 1);
+	}
+
+	return NULL;
+}
+
+static void refresh_view_applications(struct ptychite_server *server) {
+	struct ptychite_view *view;
+	wl_list_for_each(view, &server->views, server_link) {
+		ptychite_view_resolve_application(view);
+	}
+}
+
 static int handle_inotify(int fd, uint32_t mask, void *data) {
 	struct ptychite_server *server = data;
 
@@ -269,6 +321,9 @@ static int handle_inotify(int fd, uint32_t mask, void *data) {
 		i += sizeof(struct inotify_event) + event->len;
 	}
 
+	/* applications may have been freed, so cached pointers on views must be dropped */
+	refresh_view_applications(server);
+
 	return 0;
 }
 
@@ -15,5 +15,6 @@ struct ptychite_application {
 };
 
 int ptychite_server_init_applications(struct ptychite_server *server);
+struct ptychite_application *ptychite_server_lookup_application(struct ptychite_server *server, const char *app_id);
 
 #endif
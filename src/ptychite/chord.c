@@ -193,3 +193,115 @@ err:
 	wl_array_release(&output);
 	return NULL;
 }
+
+static int chord_key_compare(const struct ptychite_key *key1, const struct ptychite_key *key2) {
+	if (key1->modifiers != key2->modifiers) {
+		return key1->modifiers < key2->modifiers ? -1 : 1;
+	}
+	if (key1->sym != key2->sym) {
+		return key1->sym < key2->sym ? -1 : 1;
+	}
+
+	return 0;
+}
+
+static uint8_t chord_key_bit(const struct ptychite_key *key) {
+	return (key->sym * 31 + key->modifiers) & 0xff;
+}
+
+/* returns whether the key was found, and where it is or would be inserted */
+static bool chord_trie_node_find(
+		const struct ptychite_chord_trie_node *node, const struct ptychite_key *key, size_t *index) {
+	size_t low = 0, high = node->children_l;
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		int cmp = chord_key_compare(&node->children[mid].key, key);
+		if (!cmp) {
+			*index = mid;
+			return true;
+		} else if (cmp < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	*index = low;
+	return false;
+}
+
+static void chord_trie_node_finish(struct ptychite_chord_trie_node *node) {
+	size_t i;
+	for (i = 0; i < node->children_l; i++) {
+		chord_trie_node_finish(&node->children[i]);
+	}
+	free(node->children);
+}
+
+void ptychite_chord_trie_init(struct ptychite_chord_trie *trie) {
+	*trie = (struct ptychite_chord_trie){0};
+}
+
+void ptychite_chord_trie_clear(struct ptychite_chord_trie *trie) {
+	chord_trie_node_finish(&trie->root);
+	trie->root = (struct ptychite_chord_trie_node){0};
+	memset(trie->first_keys, 0, sizeof(trie->first_keys));
+	trie->generation++;
+}
+
+/* chords are inserted in binding order, and like the old linear scan the first binding to match a key wins, so a
+ * chord that runs into or through one inserted before it is unreachable and left out */
+int ptychite_chord_trie_insert(struct ptychite_chord_trie *trie, struct ptychite_chord *chord, void *data) {
+	struct ptychite_chord_trie_node *node = &trie->root;
+	bool created = false;
+
+	size_t i;
+	for (i = 0; i < chord->keys_l; i++) {
+		struct ptychite_key *key = &chord->keys[i];
+
+		size_t index;
+		created = !chord_trie_node_find(node, key, &index);
+		if (created) {
+			struct ptychite_chord_trie_node *children =
+					realloc(node->children, (node->children_l + 1) * sizeof(struct ptychite_chord_trie_node));
+			if (!children) {
+				return -1;
+			}
+			memmove(&children[index + 1], &children[index],
+					(node->children_l - index) * sizeof(struct ptychite_chord_trie_node));
+			children[index] = (struct ptychite_chord_trie_node){.key = *key};
+			node->children = children;
+			node->children_l++;
+		} else if (node->children[index].data) {
+			return 0;
+		}
+
+		node = &node->children[index];
+	}
+
+	if (created) {
+		node->data = data;
+		uint8_t bit = chord_key_bit(&chord->keys[0]);
+		trie->first_keys[bit / 64] |= UINT64_C(1) << (bit % 64);
+	}
+
+	return 0;
+}
+
+const struct ptychite_chord_trie_node *ptychite_chord_trie_step(struct ptychite_chord_trie *trie,
+		const struct ptychite_chord_trie_node *cursor, const struct ptychite_key *key) {
+	if (!cursor) {
+		uint8_t bit = chord_key_bit(key);
+		if (!(trie->first_keys[bit / 64] & (UINT64_C(1) << (bit % 64)))) {
+			return NULL;
+		}
+		cursor = &trie->root;
+	}
+
+	size_t index;
+	if (!chord_trie_node_find(cursor, key, &index)) {
+		return NULL;
+	}
+
+	return &cursor->children[index];
+}
@@ -14,8 +14,27 @@ struct ptychite_chord {
 	size_t keys_l;
 };
 
+struct ptychite_chord_trie_node {
+	struct ptychite_key key;
+	void *data;
+	struct ptychite_chord_trie_node *children;
+	size_t children_l;
+};
+
+struct ptychite_chord_trie {
+	struct ptychite_chord_trie_node root;
+	uint64_t first_keys[4];
+	uint32_t generation;
+};
+
 int ptychite_chord_parse_pattern(struct ptychite_chord *chord, const char *pattern, char **error);
 void ptychite_chord_deinit(struct ptychite_chord *chord);
 char *ptychite_chord_get_pattern(struct ptychite_chord *chord);
 
+void ptychite_chord_trie_init(struct ptychite_chord_trie *trie);
+void ptychite_chord_trie_clear(struct ptychite_chord_trie *trie);
+int ptychite_chord_trie_insert(struct ptychite_chord_trie *trie, struct ptychite_chord *chord, void *data);
+const struct ptychite_chord_trie_node *ptychite_chord_trie_step(struct ptychite_chord_trie *trie,
+		const struct ptychite_chord_trie_node *cursor, const struct ptychite_key *key);
+
 #endif
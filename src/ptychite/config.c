@@ -2,6 +2,7 @@
 #include <ctype.h>
 #include <pixman.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -270,6 +271,177 @@ static struct json_object *config_get_keyboard_xkb_options(struct ptychite_confi
 	return json_object_new_string(config->keyboard.xkb.options ? config->keyboard.xkb.options : "");
 }
 
+static int config_set_keyboard_xkb_layout(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	if (!json_object_is_type(value, json_type_string)) {
+		*error = "keyboard xkb layout must be a string";
+		return -1;
+	}
+	const char *layout = json_object_get_string(value);
+
+	char *layout_dup = strdup(layout);
+	if (!layout_dup) {
+		*error = "memory error";
+		return -1;
+	}
+
+	free(config->keyboard.xkb.layout);
+	config->keyboard.xkb.layout = layout_dup;
+
+	if (config->compositor) {
+		ptychite_server_configure_keyboards(config->compositor->server);
+	}
+
+	return 0;
+}
+
+static struct json_object *config_get_keyboard_xkb_layout(struct ptychite_config *config) {
+	return json_object_new_string(config->keyboard.xkb.layout ? config->keyboard.xkb.layout : "");
+}
+
+static int config_set_keyboard_xkb_variant(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	if (!json_object_is_type(value, json_type_string)) {
+		*error = "keyboard xkb variant must be a string";
+		return -1;
+	}
+	const char *variant = json_object_get_string(value);
+
+	char *variant_dup = strdup(variant);
+	if (!variant_dup) {
+		*error = "memory error";
+		return -1;
+	}
+
+	free(config->keyboard.xkb.variant);
+	config->keyboard.xkb.variant = variant_dup;
+
+	if (config->compositor) {
+		ptychite_server_configure_keyboards(config->compositor->server);
+	}
+
+	return 0;
+}
+
+static struct json_object *config_get_keyboard_xkb_variant(struct ptychite_config *config) {
+	return json_object_new_string(config->keyboard.xkb.variant ? config->keyboard.xkb.variant : "");
+}
+
+static void keyboard_device_deinit(struct ptychite_keyboard_device *device) {
+	free(device->name);
+	free(device->layout);
+	free(device->variant);
+}
+
+static void config_wipe_keyboard_devices(struct ptychite_config *config) {
+	struct ptychite_keyboard_device *device;
+	wl_array_for_each(device, &config->keyboard.xkb.devices) {
+		keyboard_device_deinit(device);
+	}
+	config->keyboard.xkb.devices.size = 0;
+}
+
+static int config_scan_keyboard_xkb_devices(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	if (!json_object_is_type(value, json_type_array)) {
+		*error = "keyboard xkb devices must be an array";
+		return -1;
+	}
+
+	if (mode == PTYCHITE_PROPERTY_SET_OVERWRITE) {
+		config_wipe_keyboard_devices(config);
+	}
+
+	size_t i;
+	struct json_object *entry;
+	JSON_ARRAY_FOREACH(value, i, entry) {
+		if (!json_object_is_type(entry, json_type_object)) {
+			*error = "each keyboard xkb device must be an object";
+			return -1;
+		}
+
+		struct json_object *name = json_object_get_and_ensure_type(entry, "name", json_type_string);
+		if (!name) {
+			*error = "each keyboard xkb device must have a member \"name\" of type string";
+			return -1;
+		}
+		struct json_object *layout = json_object_get_and_ensure_type(entry, "layout", json_type_string);
+		if (!layout) {
+			*error = "each keyboard xkb device must have a member \"layout\" of type string";
+			return -1;
+		}
+		struct json_object *variant = NULL;
+		if (json_object_object_get_ex(entry, "variant", &variant) && !json_object_is_type(variant, json_type_string)) {
+			*error = "keyboard xkb device member \"variant\" must be a string";
+			return -1;
+		}
+
+		struct ptychite_keyboard_device new_device = {
+				.name = strdup(json_object_get_string(name)),
+				.layout = strdup(json_object_get_string(layout)),
+				.variant = variant ? strdup(json_object_get_string(variant)) : NULL,
+		};
+		if (!new_device.name || !new_device.layout || (variant && !new_device.variant)) {
+			keyboard_device_deinit(&new_device);
+			*error = "memory error";
+			return -1;
+		}
+
+		struct ptychite_keyboard_device *device, *slot = NULL;
+		wl_array_for_each(device, &config->keyboard.xkb.devices) {
+			if (!strcmp(device->name, new_device.name)) {
+				keyboard_device_deinit(device);
+				slot = device;
+				break;
+			}
+		}
+		if (!slot && !(slot = wl_array_add(&config->keyboard.xkb.devices, sizeof(struct ptychite_keyboard_device)))) {
+			keyboard_device_deinit(&new_device);
+			*error = "memory error";
+			return -1;
+		}
+		*slot = new_device;
+	}
+
+	return 0;
+}
+
+static int config_set_keyboard_xkb_devices(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	int ret = config_scan_keyboard_xkb_devices(config, value, mode, error);
+
+	if (config->compositor) {
+		ptychite_server_configure_keyboards(config->compositor->server);
+	}
+
+	return ret;
+}
+
+static struct json_object *config_get_keyboard_xkb_devices(struct ptychite_config *config) {
+	struct json_object *array = json_object_new_array();
+	if (!array) {
+		return NULL;
+	}
+
+	struct ptychite_keyboard_device *device;
+	wl_array_for_each(device, &config->keyboard.xkb.devices) {
+		struct json_object *entry = json_object_new_object();
+		if (!entry || json_object_array_add(array, entry)) {
+			json_object_put(entry);
+			json_object_put(array);
+			return NULL;
+		}
+
+		json_object_object_add(entry, "name", json_object_new_string(device->name));
+		json_object_object_add(entry, "layout", json_object_new_string(device->layout));
+		if (device->variant) {
+			json_object_object_add(entry, "variant", json_object_new_string(device->variant));
+		}
+	}
+
+	return array;
+}
+
 static struct json_object *action_to_json(struct ptychite_action *action) {
 	char **args;
 	int args_l;
@@ -334,7 +506,24 @@ static int get_json_action_args(struct json_object *action, const char ***args_o
 	return 0;
 }
 
-static int config_set_keyboard_chords(
+static void config_compile_chord_bindings(struct ptychite_config *config) {
+	ptychite_chord_trie_clear(&config->keyboard.chord_trie);
+
+	struct ptychite_chord_binding *chord_binding;
+	wl_array_for_each(chord_binding, &config->keyboard.chords) {
+		if (!chord_binding->active) {
+			continue;
+		}
+
+		if (ptychite_chord_trie_insert(&config->keyboard.chord_trie, &chord_binding->chord, chord_binding)) {
+			wlr_log(WLR_ERROR, "Could not compile chord bindings: insufficent memory");
+			ptychite_chord_trie_clear(&config->keyboard.chord_trie);
+			return;
+		}
+	}
+}
+
+static int config_scan_keyboard_chords(
 		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
 	if (mode == PTYCHITE_PROPERTY_SET_OVERWRITE) {
 		ptychite_config_wipe_chord_bindings(config);
@@ -389,6 +578,16 @@ static int config_set_keyboard_chords(
 	return 0;
 }
 
+static int config_set_keyboard_chords(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	int ret = config_scan_keyboard_chords(config, value, mode, error);
+
+	/* bindings may have been added before an error, and the trie points into the array so it is rebuilt either way */
+	config_compile_chord_bindings(config);
+
+	return ret;
+}
+
 static struct json_object *config_get_keyboard_chords(struct ptychite_config *config) {
 	size_t len = 0;
 	struct ptychite_chord_binding *chord_binding;
@@ -866,6 +1065,31 @@ static struct json_object *config_get_views_map_to_front(struct ptychite_config
 	return json_object_new_boolean(config->views.map_to_front);
 }
 
+static int config_set_views_configure_timeout(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	if (!json_object_is_type(value, json_type_int)) {
+		*error = "configure timeout must be an integer";
+		return -1;
+	}
+	int configure_timeout = json_object_get_int(value);
+
+	if (configure_timeout < 1) {
+		*error = "configure timeout must be at least 1";
+		return -1;
+	} else if (configure_timeout > 1000) {
+		*error = "configure timeout must be less than or equal to 1000";
+		return -1;
+	}
+
+	config->views.configure_timeout = configure_timeout;
+
+	return 0;
+}
+
+static struct json_object *config_get_views_configure_timeout(struct ptychite_config *config) {
+	return json_object_new_int(config->views.configure_timeout);
+}
+
 static int config_set_views_title_bar_enabled(
 		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
 	if (!json_object_is_type(value, json_type_boolean)) {
@@ -980,6 +1204,428 @@ static struct json_object *config_get_monitors_default_scale(struct ptychite_con
 	return json_object_new_double(config->monitors.default_scale);
 }
 
+static int max_render_time_from_json(struct json_object *value, int *max_render_time, char **error) {
+	if (json_object_is_type(value, json_type_string)) {
+		const char *string = json_object_get_string(value);
+		if (!strcmp(string, "off")) {
+			*max_render_time = 0;
+			return 0;
+		} else if (!strcmp(string, "auto")) {
+			*max_render_time = PTYCHITE_MAX_RENDER_TIME_AUTO;
+			return 0;
+		}
+		*error = "max render time must be \"off\", \"auto\" or an integer";
+		return -1;
+	}
+
+	if (!json_object_is_type(value, json_type_int)) {
+		*error = "max render time must be \"off\", \"auto\" or an integer";
+		return -1;
+	}
+
+	int milliseconds = json_object_get_int(value);
+	if (milliseconds < 1) {
+		*error = "max render time must be at least 1";
+		return -1;
+	} else if (milliseconds > 100) {
+		*error = "max render time must be at most 100";
+		return -1;
+	}
+
+	*max_render_time = milliseconds;
+	return 0;
+}
+
+static struct json_object *max_render_time_to_json(int max_render_time) {
+	switch (max_render_time) {
+	case 0:
+		return json_object_new_string("off");
+	case PTYCHITE_MAX_RENDER_TIME_AUTO:
+		return json_object_new_string("auto");
+	default:
+		return json_object_new_int(max_render_time);
+	}
+}
+
+static int config_set_monitors_max_render_time(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	return max_render_time_from_json(value, &config->monitors.max_render_time, error);
+}
+
+static struct json_object *config_get_monitors_max_render_time(struct ptychite_config *config) {
+	return max_render_time_to_json(config->monitors.max_render_time);
+}
+
+static int config_set_monitors_dpms_timeout(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	if (!json_object_is_type(value, json_type_int)) {
+		*error = "dpms timeout must be an integer";
+		return -1;
+	}
+	int seconds = json_object_get_int(value);
+
+	if (seconds < 0) {
+		*error = "dpms timeout must not be negative";
+		return -1;
+	} else if (seconds > 86400) {
+		*error = "dpms timeout must be less than or equal to 86400";
+		return -1;
+	}
+
+	config->monitors.dpms_timeout = seconds;
+
+	if (config->compositor) {
+		ptychite_server_configure_idle(config->compositor->server);
+	}
+
+	return 0;
+}
+
+static struct json_object *config_get_monitors_dpms_timeout(struct ptychite_config *config) {
+	return json_object_new_int(config->monitors.dpms_timeout);
+}
+
+static void config_wipe_outputs(struct ptychite_config *config) {
+	struct ptychite_output_config *output;
+	wl_array_for_each(output, &config->monitors.outputs) {
+		free(output->name);
+	}
+	config->monitors.outputs.size = 0;
+}
+
+static int config_set_monitors_outputs(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	if (!json_object_is_type(value, json_type_array)) {
+		*error = "monitor outputs must be an array";
+		return -1;
+	}
+
+	if (mode == PTYCHITE_PROPERTY_SET_OVERWRITE) {
+		config_wipe_outputs(config);
+	}
+
+	size_t i;
+	struct json_object *entry;
+	JSON_ARRAY_FOREACH(value, i, entry) {
+		if (!json_object_is_type(entry, json_type_object)) {
+			*error = "each monitor output must be an object";
+			return -1;
+		}
+
+		struct json_object *name = json_object_get_and_ensure_type(entry, "name", json_type_string);
+		if (!name) {
+			*error = "each monitor output must have a member \"name\" of type string";
+			return -1;
+		}
+
+		struct json_object *max_render_time;
+		if (!json_object_object_get_ex(entry, "max_render_time", &max_render_time)) {
+			*error = "each monitor output must have a member \"max_render_time\"";
+			return -1;
+		}
+		struct ptychite_output_config new_output;
+		if (max_render_time_from_json(max_render_time, &new_output.max_render_time, error)) {
+			return -1;
+		}
+
+		if (!(new_output.name = strdup(json_object_get_string(name)))) {
+			*error = "memory error";
+			return -1;
+		}
+
+		struct ptychite_output_config *output, *slot = NULL;
+		wl_array_for_each(output, &config->monitors.outputs) {
+			if (!strcmp(output->name, new_output.name)) {
+				free(output->name);
+				slot = output;
+				break;
+			}
+		}
+		if (!slot && !(slot = wl_array_add(&config->monitors.outputs, sizeof(struct ptychite_output_config)))) {
+			free(new_output.name);
+			*error = "memory error";
+			return -1;
+		}
+		*slot = new_output;
+	}
+
+	return 0;
+}
+
+static struct json_object *config_get_monitors_outputs(struct ptychite_config *config) {
+	struct json_object *array = json_object_new_array();
+	if (!array) {
+		return NULL;
+	}
+
+	struct ptychite_output_config *output;
+	wl_array_for_each(output, &config->monitors.outputs) {
+		struct json_object *entry = json_object_new_object();
+		if (!entry || json_object_array_add(array, entry)) {
+			json_object_put(entry);
+			json_object_put(array);
+			return NULL;
+		}
+
+		json_object_object_add(entry, "name", json_object_new_string(output->name));
+		json_object_object_add(entry, "max_render_time", max_render_time_to_json(output->max_render_time));
+	}
+
+	return array;
+}
+
+static const char *output_transform_names[] = {
+		"normal",
+		"90",
+		"180",
+		"270",
+		"flipped",
+		"flipped-90",
+		"flipped-180",
+		"flipped-270",
+};
+
+static void output_profile_deinit(struct ptychite_output_profile *profile) {
+	size_t i;
+	for (i = 0; i < profile->outputs_len; i++) {
+		free(profile->outputs[i].match);
+	}
+	free(profile->outputs);
+	free(profile->name);
+}
+
+static void config_wipe_profiles(struct ptychite_config *config) {
+	struct ptychite_output_profile *profile;
+	wl_array_for_each(profile, &config->monitors.profiles) {
+		output_profile_deinit(profile);
+	}
+	config->monitors.profiles.size = 0;
+}
+
+static int output_profile_output_from_json(
+		struct json_object *entry, struct ptychite_output_profile_output *output, char **error) {
+	if (!json_object_is_type(entry, json_type_object)) {
+		*error = "each profile output must be an object";
+		return -1;
+	}
+
+	*output = (struct ptychite_output_profile_output){.enabled = true};
+
+	struct json_object *match = json_object_get_and_ensure_type(entry, "match", json_type_string);
+	if (!match) {
+		*error = "each profile output must have a member \"match\" of type string";
+		return -1;
+	}
+
+	struct json_object *member;
+	if (json_object_object_get_ex(entry, "enabled", &member)) {
+		if (!json_object_is_type(member, json_type_boolean)) {
+			*error = "profile output enabled must be a boolean";
+			return -1;
+		}
+		output->enabled = json_object_get_boolean(member);
+	}
+
+	if (json_object_object_get_ex(entry, "mode", &member)) {
+		double refresh = 0;
+		if (!json_object_is_type(member, json_type_string) ||
+				sscanf(json_object_get_string(member), "%dx%d@%lf", &output->width, &output->height, &refresh) < 2 ||
+				output->width <= 0 || output->height <= 0 || refresh < 0) {
+			*error = "profile output mode must be a string of the form \"WIDTHxHEIGHT\" or \"WIDTHxHEIGHT@HZ\"";
+			return -1;
+		}
+		output->refresh = refresh * 1000;
+	}
+
+	if (json_object_object_get_ex(entry, "scale", &member)) {
+		if (!json_object_is_type(member, json_type_double) && !json_object_is_type(member, json_type_int)) {
+			*error = "profile output scale must be a number";
+			return -1;
+		}
+		if ((output->scale = json_object_get_double(member)) <= 0) {
+			*error = "profile output scale must be greater than zero";
+			return -1;
+		}
+	}
+
+	if (json_object_object_get_ex(entry, "transform", &member)) {
+		if (!json_object_is_type(member, json_type_string)) {
+			*error = "profile output transform must be a string";
+			return -1;
+		}
+		size_t i;
+		for (i = 0; i < LENGTH(output_transform_names); i++) {
+			if (!strcmp(json_object_get_string(member), output_transform_names[i])) {
+				break;
+			}
+		}
+		if (i == LENGTH(output_transform_names)) {
+			*error = "profile output transform must be one of \"normal\", \"90\", \"180\", \"270\", \"flipped\", "
+					 "\"flipped-90\", \"flipped-180\" or \"flipped-270\"";
+			return -1;
+		}
+		output->transform = i;
+	}
+
+	if (json_object_object_get_ex(entry, "position", &member)) {
+		if (!json_object_is_type(member, json_type_array) || json_object_array_length(member) != 2 ||
+				!json_object_is_type(json_object_array_get_idx(member, 0), json_type_int) ||
+				!json_object_is_type(json_object_array_get_idx(member, 1), json_type_int)) {
+			*error = "profile output position must be an array of two integers";
+			return -1;
+		}
+		output->position_set = true;
+		output->x = json_object_get_int(json_object_array_get_idx(member, 0));
+		output->y = json_object_get_int(json_object_array_get_idx(member, 1));
+	}
+
+	if (!(output->match = strdup(json_object_get_string(match)))) {
+		*error = "memory error";
+		return -1;
+	}
+
+	return 0;
+}
+
+static int config_set_monitors_profiles(
+		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
+	if (!json_object_is_type(value, json_type_array)) {
+		*error = "monitor profiles must be an array";
+		return -1;
+	}
+
+	if (mode == PTYCHITE_PROPERTY_SET_OVERWRITE) {
+		config_wipe_profiles(config);
+	}
+
+	size_t i;
+	struct json_object *entry;
+	JSON_ARRAY_FOREACH(value, i, entry) {
+		if (!json_object_is_type(entry, json_type_object)) {
+			*error = "each monitor profile must be an object";
+			return -1;
+		}
+
+		struct json_object *name = json_object_get_and_ensure_type(entry, "name", json_type_string);
+		if (!name) {
+			*error = "each monitor profile must have a member \"name\" of type string";
+			return -1;
+		}
+
+		struct json_object *outputs = json_object_get_and_ensure_type(entry, "outputs", json_type_array);
+		if (!outputs || !json_object_array_length(outputs)) {
+			*error = "each monitor profile must have a member \"outputs\" of type array that is not empty";
+			return -1;
+		}
+
+		struct ptychite_output_profile new_profile = {0};
+		if (!(new_profile.name = strdup(json_object_get_string(name))) ||
+				!(new_profile.outputs = calloc(
+						  json_object_array_length(outputs), sizeof(struct ptychite_output_profile_output)))) {
+			output_profile_deinit(&new_profile);
+			*error = "memory error";
+			return -1;
+		}
+
+		size_t j;
+		struct json_object *output;
+		JSON_ARRAY_FOREACH(outputs, j, output) {
+			if (output_profile_output_from_json(output, &new_profile.outputs[j], error)) {
+				output_profile_deinit(&new_profile);
+				return -1;
+			}
+			new_profile.outputs_len++;
+		}
+
+		struct ptychite_output_profile *profile, *slot = NULL;
+		wl_array_for_each(profile, &config->monitors.profiles) {
+			if (!strcmp(profile->name, new_profile.name)) {
+				output_profile_deinit(profile);
+				slot = profile;
+				break;
+			}
+		}
+		if (!slot && !(slot = wl_array_add(&config->monitors.profiles, sizeof(struct ptychite_output_profile)))) {
+			output_profile_deinit(&new_profile);
+			*error = "memory error";
+			return -1;
+		}
+		*slot = new_profile;
+	}
+
+	return 0;
+}
+
+static struct json_object *output_profile_output_to_json(const struct ptychite_output_profile_output *output) {
+	struct json_object *entry = json_object_new_object();
+	if (!entry) {
+		return NULL;
+	}
+
+	json_object_object_add(entry, "match", json_object_new_string(output->match));
+	json_object_object_add(entry, "enabled", json_object_new_boolean(output->enabled));
+	if (output->width) {
+		char mode[64];
+		if (output->refresh) {
+			snprintf(mode, sizeof(mode), "%dx%d@%.3f", output->width, output->height, output->refresh / 1000.0);
+		} else {
+			snprintf(mode, sizeof(mode), "%dx%d", output->width, output->height);
+		}
+		json_object_object_add(entry, "mode", json_object_new_string(mode));
+	}
+	if (output->scale > 0) {
+		json_object_object_add(entry, "scale", json_object_new_double(output->scale));
+	}
+	json_object_object_add(entry, "transform", json_object_new_string(output_transform_names[output->transform]));
+	if (output->position_set) {
+		struct json_object *position = json_object_new_array_ext(2);
+		if (position) {
+			json_object_array_add(position, json_object_new_int(output->x));
+			json_object_array_add(position, json_object_new_int(output->y));
+		}
+		json_object_object_add(entry, "position", position);
+	}
+
+	return entry;
+}
+
+static struct json_object *config_get_monitors_profiles(struct ptychite_config *config) {
+	struct json_object *array = json_object_new_array();
+	if (!array) {
+		return NULL;
+	}
+
+	struct ptychite_output_profile *profile;
+	wl_array_for_each(profile, &config->monitors.profiles) {
+		struct json_object *entry = json_object_new_object();
+		if (!entry || json_object_array_add(array, entry)) {
+			json_object_put(entry);
+			json_object_put(array);
+			return NULL;
+		}
+
+		struct json_object *outputs = json_object_new_array_ext(profile->outputs_len);
+		if (!outputs) {
+			json_object_put(array);
+			return NULL;
+		}
+		json_object_object_add(entry, "name", json_object_new_string(profile->name));
+		json_object_object_add(entry, "outputs", outputs);
+
+		size_t i;
+		for (i = 0; i < profile->outputs_len; i++) {
+			struct json_object *output = output_profile_output_to_json(&profile->outputs[i]);
+			if (!output || json_object_array_add(outputs, output)) {
+				json_object_put(output);
+				json_object_put(array);
+				return NULL;
+			}
+		}
+	}
+
+	return array;
+}
+
 static int config_set_monitors_wallpaper_filepath(
 		struct ptychite_config *config, struct json_object *value, enum ptychite_property_set_mode mode, char **error) {
 	if (!json_object_is_type(value, json_type_string)) {
@@ -1101,8 +1747,12 @@ static int config_set_tiling_mode(
 		tiling_mode = PTYCHITE_TILING_NONE;
 	} else if (!strcmp(string, "traditional")) {
 		tiling_mode = PTYCHITE_TILING_TRADITIONAL;
+	} else if (!strcmp(string, "mosaic")) {
+		tiling_mode = PTYCHITE_TILING_MOSAIC;
+	} else if (!strcmp(string, "scrollable")) {
+		tiling_mode = PTYCHITE_TILING_SCROLLABLE;
 	} else {
-		*error = "invalid tiling mode, available values are 'none' and 'traditional'";
+		*error = "invalid tiling mode, available values are 'none', 'traditional', 'mosaic' and 'scrollable'";
 		return -1;
 	}
 
@@ -1124,6 +1774,12 @@ static struct json_object *config_get_tiling_mode(struct ptychite_config *config
 	case PTYCHITE_TILING_TRADITIONAL:
 		string = "traditional";
 		break;
+	case PTYCHITE_TILING_MOSAIC:
+		string = "mosaic";
+		break;
+	case PTYCHITE_TILING_SCROLLABLE:
+		string = "scrollable";
+		break;
 	default:
 		return NULL;
 	}
@@ -1167,6 +1823,12 @@ static const struct property_entry config_property_table[] = {
 				config_get_keyboard_repeat_delay},
 		{(const char *[]){"keyboard", "xkb", "options", NULL}, config_set_keyboard_xkb_options,
 				config_get_keyboard_xkb_options},
+		{(const char *[]){"keyboard", "xkb", "layout", NULL}, config_set_keyboard_xkb_layout,
+				config_get_keyboard_xkb_layout},
+		{(const char *[]){"keyboard", "xkb", "variant", NULL}, config_set_keyboard_xkb_variant,
+				config_get_keyboard_xkb_variant},
+		{(const char *[]){"keyboard", "xkb", "devices", NULL}, config_set_keyboard_xkb_devices,
+				config_get_keyboard_xkb_devices},
 		{(const char *[]){"keyboard", "chords", NULL}, config_set_keyboard_chords, config_get_keyboard_chords},
 
 		{(const char *[]){"panel", "enabled", NULL}, config_set_panel_enabled, config_get_panel_enabled},
@@ -1189,6 +1851,8 @@ static const struct property_entry config_property_table[] = {
 		{(const char *[]){"panel", "colors", "chord", NULL}, config_set_panel_colors_chord, config_get_panel_colors_chord},
 
 		{(const char *[]){"views", "map_to_front", NULL}, config_set_views_map_to_front, config_get_views_map_to_front},
+		{(const char *[]){"views", "configure_timeout", NULL}, config_set_views_configure_timeout,
+				config_get_views_configure_timeout},
 		{(const char *[]){"views", "title_bar", "enabled", NULL}, config_set_views_title_bar_enabled,
 				config_get_views_title_bar_enabled},
 		{(const char *[]){"views", "title_bar", "colors", "close", NULL}, config_set_views_title_bar_colors_close,
@@ -1202,6 +1866,12 @@ static const struct property_entry config_property_table[] = {
 
 		{(const char *[]){"monitors", "default_scale", NULL}, config_set_monitors_default_scale,
 				config_get_monitors_default_scale},
+		{(const char *[]){"monitors", "max_render_time", NULL}, config_set_monitors_max_render_time,
+				config_get_monitors_max_render_time},
+		{(const char *[]){"monitors", "dpms_timeout", NULL}, config_set_monitors_dpms_timeout,
+				config_get_monitors_dpms_timeout},
+		{(const char *[]){"monitors", "outputs", NULL}, config_set_monitors_outputs, config_get_monitors_outputs},
+		{(const char *[]){"monitors", "profiles", NULL}, config_set_monitors_profiles, config_get_monitors_profiles},
 		{(const char *[]){"monitors", "wallpaper", "filepath", NULL}, config_set_monitors_wallpaper_filepath,
 				config_get_monitors_wallpaper_filepath},
 		{(const char *[]){"monitors", "wallpaper", "mode", NULL}, config_set_monitors_wallpaper_mode,
@@ -1457,7 +2127,11 @@ int ptychite_config_init(struct ptychite_config *config, struct ptychite_composi
 	config->keyboard.repeat.rate = 25;
 	config->keyboard.repeat.delay = 600;
 	config->keyboard.xkb.options = NULL;
+	config->keyboard.xkb.layout = NULL;
+	config->keyboard.xkb.variant = NULL;
+	wl_array_init(&config->keyboard.xkb.devices);
 	wl_array_init(&config->keyboard.chords);
+	ptychite_chord_trie_init(&config->keyboard.chord_trie);
 
 	/* FIXME errors should be const */
 	char *error;
@@ -1471,6 +2145,7 @@ int ptychite_config_init(struct ptychite_config *config, struct ptychite_composi
 			goto err;
 		}
 	}
+	config_compile_chord_bindings(config);
 
 	config->panel.enabled = true;
 	if (font_fill_from_string(&config->panel.font, "monospace bold 12", &error)) {
@@ -1537,6 +2212,7 @@ int ptychite_config_init(struct ptychite_config *config, struct ptychite_composi
 	config->panel.colors.chord[3] = 1.0;
 
 	config->views.map_to_front = true;
+	config->views.configure_timeout = 50;
 	config->views.title_bar.enabled = true;
 	config->views.title_bar.colors.close[0] = 0.8;
 	config->views.title_bar.colors.close[1] = 0.0;
@@ -1553,6 +2229,10 @@ int ptychite_config_init(struct ptychite_config *config, struct ptychite_composi
 	config->views.border.colors.inactive[3] = 1.0;
 
 	config->monitors.default_scale = 1.0;
+	config->monitors.max_render_time = 0;
+	config->monitors.dpms_timeout = 0;
+	wl_array_init(&config->monitors.outputs);
+	wl_array_init(&config->monitors.profiles);
 	config->monitors.wallpaper.path = NULL;
 	config->monitors.wallpaper.mode = PTYCHITE_WALLPAPER_FIT;
 	config->monitors.wallpaper.surface = NULL;
@@ -1587,6 +2267,16 @@ void ptychite_config_wipe_chord_bindings(struct ptychite_config *config) {
 void ptychite_config_deinit(struct ptychite_config *config) {
 	ptychite_config_wipe_chord_bindings(config);
 	wl_array_release(&config->keyboard.chords);
+	ptychite_chord_trie_clear(&config->keyboard.chord_trie);
+	config_wipe_keyboard_devices(config);
+	wl_array_release(&config->keyboard.xkb.devices);
+	free(config->keyboard.xkb.options);
+	free(config->keyboard.xkb.layout);
+	free(config->keyboard.xkb.variant);
+	config_wipe_outputs(config);
+	wl_array_release(&config->monitors.outputs);
+	config_wipe_profiles(config);
+	wl_array_release(&config->monitors.profiles);
 	pango_font_description_free(config->panel.font.font);
 	free(config->panel.font.string);
 	deinit_panel_section(&config->panel.sections.left);
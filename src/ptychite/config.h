@@ -24,6 +24,8 @@ enum ptychite_wallpaper_mode {
 enum ptychite_tiling_mode {
 	PTYCHITE_TILING_NONE,
 	PTYCHITE_TILING_TRADITIONAL,
+	PTYCHITE_TILING_MOSAIC,
+	PTYCHITE_TILING_SCROLLABLE,
 };
 
 struct ptychite_chord_binding {
@@ -32,6 +34,40 @@ struct ptychite_chord_binding {
 	bool active;
 };
 
+struct ptychite_keyboard_device {
+	char *name;
+	char *layout;
+	char *variant;
+};
+
+/* max render time is in milliseconds, PTYCHITE_MAX_RENDER_TIME_AUTO measures it and 0 commits right away */
+#define PTYCHITE_MAX_RENDER_TIME_AUTO -1
+
+struct ptychite_output_config {
+	char *name;
+	int max_render_time;
+};
+
+/* match is a connector name, "make model serial" with "Unknown" for missing parts, or "*" */
+struct ptychite_output_profile_output {
+	char *match;
+	bool enabled;
+	/* a zero width keeps the preferred mode, refresh is in mHz and zero picks the fastest */
+	int width, height, refresh;
+	/* zero falls back to the default scale */
+	float scale;
+	int transform;
+	bool position_set;
+	int x, y;
+};
+
+/* a profile applies when every connected output is matched by exactly one of its outputs */
+struct ptychite_output_profile {
+	char *name;
+	struct ptychite_output_profile_output *outputs;
+	size_t outputs_len;
+};
+
 struct ptychite_font {
 	PangoFontDescription *font;
 	char *string;
@@ -76,8 +112,12 @@ struct ptychite_config {
 		} repeat;
 		struct {
 			char *options;
+			char *layout;
+			char *variant;
+			struct wl_array devices;
 		} xkb;
 		struct wl_array chords;
+		struct ptychite_chord_trie chord_trie;
 	} keyboard;
 
 	struct {
@@ -103,6 +143,7 @@ struct ptychite_config {
 
 	struct {
 		bool map_to_front;
+		int configure_timeout;
 		struct {
 			bool enabled;
 			struct {
@@ -120,6 +161,10 @@ struct ptychite_config {
 
 	struct {
 		float default_scale;
+		int max_render_time;
+		int dpms_timeout;
+		struct wl_array outputs;
+		struct wl_array profiles;
 		struct {
 			char *path;
 			enum ptychite_wallpaper_mode mode;
@@ -0,0 +1,174 @@
+#define _POSIX_C_SOURCE 200809L
+#include <math.h>
+#include <stdlib.h>
+
+#include "grid.h"
+
+#define GRID_CELL_SIZE 128
+
+void ptychite_hit_grid_init(struct ptychite_hit_grid *grid) {
+	grid->box = (struct wlr_box){0};
+	grid->columns = grid->rows = 0;
+	wl_array_init(&grid->cells);
+	grid->dirty = true;
+}
+
+void ptychite_hit_grid_finish(struct ptychite_hit_grid *grid) {
+	struct wl_array *cell;
+	wl_array_for_each(cell, &grid->cells) {
+		wl_array_release(cell);
+	}
+	wl_array_release(&grid->cells);
+}
+
+static bool grid_node_bounds(struct wlr_scene_node *node, int lx, int ly, struct wlr_box *bounds) {
+	if (!node->enabled) {
+		return false;
+	}
+	lx += node->x;
+	ly += node->y;
+
+	int width = 0, height = 0;
+	switch (node->type) {
+	case WLR_SCENE_NODE_TREE: {
+		bool found = false;
+		struct wlr_scene_tree *tree = wlr_scene_tree_from_node(node);
+		struct wlr_scene_node *child;
+		wl_list_for_each(child, &tree->children, link) {
+			struct wlr_box child_bounds;
+			if (!grid_node_bounds(child, lx, ly, &child_bounds)) {
+				continue;
+			}
+			if (found) {
+				int x2 = fmax(bounds->x + bounds->width, child_bounds.x + child_bounds.width);
+				int y2 = fmax(bounds->y + bounds->height, child_bounds.y + child_bounds.height);
+				bounds->x = fmin(bounds->x, child_bounds.x);
+				bounds->y = fmin(bounds->y, child_bounds.y);
+				bounds->width = x2 - bounds->x;
+				bounds->height = y2 - bounds->y;
+			} else {
+				*bounds = child_bounds;
+				found = true;
+			}
+		}
+		return found;
+	}
+	case WLR_SCENE_NODE_RECT: {
+		struct wlr_scene_rect *rect = wlr_scene_rect_from_node(node);
+		width = rect->width;
+		height = rect->height;
+		break;
+	}
+	case WLR_SCENE_NODE_BUFFER: {
+		struct wlr_scene_buffer *buffer = wlr_scene_buffer_from_node(node);
+		width = buffer->dst_width;
+		height = buffer->dst_height;
+		if ((!width || !height) && buffer->buffer) {
+			width = buffer->buffer->width;
+			height = buffer->buffer->height;
+		}
+		break;
+	}
+	}
+
+	if (width <= 0 || height <= 0) {
+		return false;
+	}
+
+	*bounds = (struct wlr_box){.x = lx, .y = ly, .width = width, .height = height};
+	return true;
+}
+
+static void grid_insert(struct ptychite_hit_grid *grid, struct wlr_scene_node *node, const struct wlr_box *bounds) {
+	struct wlr_box box;
+	if (!wlr_box_intersection(&box, bounds, &grid->box)) {
+		return;
+	}
+
+	int column_start = (box.x - grid->box.x) / GRID_CELL_SIZE;
+	int column_end = (box.x + box.width - 1 - grid->box.x) / GRID_CELL_SIZE;
+	int row_start = (box.y - grid->box.y) / GRID_CELL_SIZE;
+	int row_end = (box.y + box.height - 1 - grid->box.y) / GRID_CELL_SIZE;
+
+	struct wl_array *cells = grid->cells.data;
+	for (int row = row_start; row <= row_end; row++) {
+		for (int column = column_start; column <= column_end; column++) {
+			struct wlr_scene_node **entry =
+					wl_array_add(&cells[row * grid->columns + column], sizeof(struct wlr_scene_node *));
+			if (entry) {
+				*entry = node;
+			}
+		}
+	}
+}
+
+/* elements are indexed as a whole, so a hit inside one is resolved by the scene graph within that subtree only */
+static void grid_collect(struct ptychite_hit_grid *grid, struct wlr_scene_node *node, int lx, int ly) {
+	if (!node->enabled) {
+		return;
+	}
+
+	if (node->type == WLR_SCENE_NODE_TREE && !node->data) {
+		struct wlr_scene_tree *tree = wlr_scene_tree_from_node(node);
+		struct wlr_scene_node *child;
+		wl_list_for_each(child, &tree->children, link) {
+			grid_collect(grid, child, lx + node->x, ly + node->y);
+		}
+		return;
+	}
+
+	struct wlr_box bounds;
+	if (grid_node_bounds(node, lx, ly, &bounds)) {
+		grid_insert(grid, node, &bounds);
+	}
+}
+
+bool ptychite_hit_grid_rebuild(struct ptychite_hit_grid *grid, struct wlr_scene_tree *root, const struct wlr_box *box) {
+	int columns = (box->width + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+	int rows = (box->height + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+
+	struct wl_array *cell;
+	if (columns * rows * sizeof(struct wl_array) != grid->cells.size) {
+		ptychite_hit_grid_finish(grid);
+		wl_array_init(&grid->cells);
+		grid->columns = grid->rows = 0;
+		if (!wl_array_add(&grid->cells, columns * rows * sizeof(struct wl_array))) {
+			return false;
+		}
+		wl_array_for_each(cell, &grid->cells) {
+			wl_array_init(cell);
+		}
+	} else {
+		wl_array_for_each(cell, &grid->cells) {
+			cell->size = 0;
+		}
+	}
+
+	grid->box = *box;
+	grid->columns = columns;
+	grid->rows = rows;
+	grid_collect(grid, &root->node, 0, 0);
+	grid->dirty = false;
+
+	return true;
+}
+
+struct wlr_scene_node *ptychite_hit_grid_node_at(
+		struct ptychite_hit_grid *grid, double lx, double ly, double *nx, double *ny) {
+	int column = (floor(lx) - grid->box.x) / GRID_CELL_SIZE;
+	int row = (floor(ly) - grid->box.y) / GRID_CELL_SIZE;
+	if (lx < grid->box.x || ly < grid->box.y || column >= grid->columns || row >= grid->rows) {
+		return NULL;
+	}
+
+	struct wl_array *cell = &((struct wl_array *)grid->cells.data)[row * grid->columns + column];
+	struct wlr_scene_node **entries = cell->data;
+	for (size_t i = cell->size / sizeof(struct wlr_scene_node *); i > 0; i--) {
+		struct wlr_scene_node *node = wlr_scene_node_at(entries[i - 1], lx, ly, nx, ny);
+		if (node) {
+			return node;
+		}
+	}
+
+	return NULL;
+}
@@ -0,0 +1,25 @@
+#ifndef PTYCHITE_GRID_H
+#define PTYCHITE_GRID_H
+
+#include <stdbool.h>
+#include <wayland-util.h>
+
+#include <wlr/types/wlr_scene.h>
+#include <wlr/util/box.h>
+
+/* a uniform grid over one output of the nodes that can be hit by the cursor, each cell lists the elements (or
+ * loose leaf nodes) overlapping it from bottom to top */
+struct ptychite_hit_grid {
+	struct wlr_box box;
+	int columns, rows;
+	struct wl_array cells;
+	bool dirty;
+};
+
+void ptychite_hit_grid_init(struct ptychite_hit_grid *grid);
+void ptychite_hit_grid_finish(struct ptychite_hit_grid *grid);
+bool ptychite_hit_grid_rebuild(struct ptychite_hit_grid *grid, struct wlr_scene_tree *root, const struct wlr_box *box);
+struct wlr_scene_node *ptychite_hit_grid_node_at(
+		struct ptychite_hit_grid *grid, double lx, double ly, double *nx, double *ny);
+
+#endif
@@ -8,6 +8,7 @@
 #include "config.h"
 #include "keyboard.h"
 #include "monitor.h"
+#include "record.h"
 #include "server.h"
 #include "src/ptychite/view.h"
 #include "windows.h"
@@ -18,6 +19,14 @@ static void keyboard_handle_key(struct wl_listener *listener, void *data) {
 	struct ptychite_server *server = keyboard->server;
 	struct wlr_seat *seat = server->seat;
 
+	if (server->recorder) {
+		ptychite_recorder_key(server->recorder, keyboard->keyboard, event);
+	}
+	if (server->active_monitor) {
+		ptychite_monitor_stamp_input(server->active_monitor);
+	}
+	ptychite_server_notify_activity(server);
+
 	uint32_t keycode = event->keycode + 8;
 	const xkb_keysym_t *syms;
 	int nsyms = xkb_state_key_get_syms(keyboard->keyboard->xkb_state, keycode, &syms);
@@ -28,6 +37,13 @@ static void keyboard_handle_key(struct wl_listener *listener, void *data) {
 	if (event->state == WL_KEYBOARD_KEY_STATE_PRESSED) {
 		size_t old_keys_size = server->keys.size;
 
+		struct ptychite_chord_trie *chord_trie = &server->compositor->config->keyboard.chord_trie;
+		if (server->chord_generation != chord_trie->generation) {
+			server->chord_generation = chord_trie->generation;
+			server->chord_cursor = NULL;
+			server->keys.size = 0;
+		}
+
 		int i;
 		for (i = 0; i < nsyms; i++) {
 			if (server->keys.size &&
@@ -39,55 +55,34 @@ static void keyboard_handle_key(struct wl_listener *listener, void *data) {
 				continue;
 			}
 
-			bool match = false;
-			struct ptychite_chord_binding *chord_binding;
-			wl_array_for_each(chord_binding, &server->compositor->config->keyboard.chords) {
-				if (!chord_binding->active) {
-					continue;
-				}
-
-				size_t length = chord_binding->chord.keys_l;
-				size_t progress = server->keys.size / sizeof(struct ptychite_key);
-				if (length <= progress) {
-					continue;
-				}
-
-				bool pass = false;
-				size_t j;
-				for (j = 0; j < progress; j++) {
-					struct ptychite_key *key_binding = &chord_binding->chord.keys[j];
-					struct ptychite_key *key_current = &((struct ptychite_key *)server->keys.data)[j];
-					if (key_binding->sym != key_current->sym || key_binding->modifiers != key_current->modifiers) {
-						pass = true;
-						break;
-					}
-				}
-				if (pass) {
-					continue;
-				}
-
-				struct ptychite_key *key = &chord_binding->chord.keys[progress];
-				if (syms[i] != key->sym || modifiers != key->modifiers) {
-					continue;
-				}
-
-				handled = match = true;
-				if (length == progress + 1) {
-					ptychite_server_execute_action(server, chord_binding->action);
+			struct ptychite_key key = {.sym = syms[i], .modifiers = modifiers};
+			const struct ptychite_chord_trie_node *node =
+					ptychite_chord_trie_step(chord_trie, server->chord_cursor, &key);
+			bool match = node;
+			if (node) {
+				handled = true;
+				if (node->data) {
+					struct ptychite_chord_binding *chord_binding = node->data;
+					server->chord_cursor = NULL;
 					server->keys.size = 0;
+					ptychite_server_execute_action(server, chord_binding->action);
+					if (server->active_monitor) {
+						ptychite_monitor_note_input_response(server->active_monitor);
+					}
 				} else {
 					struct ptychite_key *append = wl_array_add(&server->keys, sizeof(struct ptychite_key));
-					if (!append) {
+					if (append) {
+						*append = key;
+						server->chord_cursor = node;
+					} else {
+						server->chord_cursor = NULL;
 						server->keys.size = 0;
-						break;
 					}
-					*append = (struct ptychite_key){.sym = syms[i], .modifiers = modifiers};
 				}
-
-				break;
 			}
 
 			if (!match) {
+				server->chord_cursor = NULL;
 				if (server->keys.size) {
 					server->keys.size = 0;
 					handled = true;
@@ -148,6 +143,7 @@ static void keyboard_handle_key(struct wl_listener *listener, void *data) {
 			wl_list_for_each(monitor, &server->monitors, link) {
 				if (monitor->panel && monitor->panel->base.element.scene_tree->node.enabled) {
 					ptychite_window_relay_draw_same_size(&monitor->panel->base);
+					ptychite_monitor_note_input_response(monitor);
 				}
 			}
 		}
@@ -157,6 +153,7 @@ static void keyboard_handle_key(struct wl_listener *listener, void *data) {
 			/* FIXME just a temporary way to get app switching to work with default keybind */
 			if (syms[i] == XKB_KEY_Super_L && server->switcher.base.element.scene_tree->node.enabled) {
 				wlr_scene_node_set_enabled(&server->switcher.base.element.scene_tree->node, false);
+				ptychite_server_invalidate_hit_grids(server);
 
 				int idx = 0;
 				bool found = false;
@@ -172,6 +169,9 @@ static void keyboard_handle_key(struct wl_listener *listener, void *data) {
 				if (found) {
 					ptychite_view_focus(view, view->xdg_toplevel->base->surface);
 				}
+				if (server->active_monitor) {
+					ptychite_monitor_note_input_response(server->active_monitor);
+				}
 
 				handled = true;
 				break;
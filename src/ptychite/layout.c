@@ -0,0 +1,249 @@
+#define _POSIX_C_SOURCE 200809L
+#include <math.h>
+#include <string.h>
+
+#include "layout.h"
+
+static void layout_clamp(const struct ptychite_layout_hint *hint, int *width, int *height) {
+	*width = fmax(hint->min_width, *width);
+	*height = fmax(hint->min_height, *height);
+	*width = fmin(hint->max_width, *width);
+	*height = fmin(hint->max_height, *height);
+}
+
+static void layout_traditional_arrange(const struct ptychite_layout_hint *hints, size_t len,
+		const struct wlr_box *area, int gaps, const struct ptychite_layout_params *params, struct wlr_box *boxes) {
+	int views_len = len;
+	int views_in_master = params->traditional.views_in_master;
+	double master_factor = params->traditional.master_factor;
+	bool right_master = params->traditional.right_master;
+
+	int master_width;
+	if (views_len > views_in_master) {
+		master_width = views_in_master ? (area->width + gaps) * master_factor : 0;
+	} else {
+		master_width = area->width - gaps;
+	}
+
+	int master_x = area->x + (right_master ? area->width - master_width : gaps);
+	int stack_x = area->x + (right_master ? gaps : master_width + gaps);
+	int master_y = gaps;
+	int stack_y = gaps;
+	for (int i = 0; i < views_len; i++) {
+		struct wlr_box *box = &boxes[i];
+		if (i < views_in_master) {
+			int r = fmin(views_len, views_in_master) - i;
+			box->x = master_x;
+			box->y = area->y + master_y;
+			box->width = master_width - gaps;
+			box->height = (area->height - master_y - gaps * r) / r;
+			layout_clamp(&hints[i], &box->width, &box->height);
+			master_y += box->height + gaps;
+		} else {
+			int r = views_len - i;
+			box->x = stack_x;
+			box->y = area->y + stack_y;
+			box->width = area->width - master_width - 2 * gaps;
+			box->height = (area->height - stack_y - gaps * r) / r;
+			layout_clamp(&hints[i], &box->width, &box->height);
+			stack_y += box->height + gaps;
+		}
+	}
+}
+
+const struct ptychite_layout ptychite_layout_traditional = {
+		.name = "traditional",
+		.arrange = layout_traditional_arrange,
+};
+
+static double mosaic_aspect(const struct ptychite_layout_hint *hint) {
+	if (!(hint->aspect > 0)) {
+		return 1;
+	}
+
+	return fmin(fmax(hint->aspect, 0.25), 4);
+}
+
+/* views are split into contiguous rows of roughly equal aspect sum, each row is justified to the full width
+ * and the rows are then scaled together to fill the height, returns how far that scale is from 1 */
+static double mosaic_arrange_rows(const struct ptychite_layout_hint *hints, size_t len, const struct wlr_box *area,
+		int gaps, int rows, double total, struct wlr_box *boxes) {
+	double natural_height = 0;
+	int rows_used = 0;
+
+	for (int pass = 0; pass < (boxes ? 2 : 1); pass++) {
+		double scale = 1;
+		if (pass) {
+			double available = area->height - gaps * (rows_used + 1);
+			scale = fmax(available, 0) / natural_height;
+		}
+		double y = area->y + gaps;
+		double before = 0;
+
+		size_t start = 0;
+		while (start < len) {
+			int row = fmin(rows - 1, (before + mosaic_aspect(&hints[start]) / 2) * rows / total);
+
+			size_t end = start;
+			double sum = 0;
+			double row_before = before;
+			while (end < len) {
+				double aspect = mosaic_aspect(&hints[end]);
+				if ((int)fmin(rows - 1, (row_before + aspect / 2) * rows / total) != row) {
+					break;
+				}
+				sum += aspect;
+				row_before += aspect;
+				end++;
+			}
+
+			double width = area->width - gaps * (int)(end - start + 1);
+			if (width <= 0) {
+				if (!boxes) {
+					return INFINITY;
+				}
+				width = 1;
+			}
+			double height = width / sum;
+
+			if (!pass) {
+				natural_height += height;
+				rows_used++;
+			} else {
+				double next_y = y + height * scale;
+				double x = area->x + gaps;
+				for (size_t i = start; i < end; i++) {
+					double next_x = x + width * mosaic_aspect(&hints[i]) / sum;
+					struct wlr_box *box = &boxes[i];
+					box->x = round(x);
+					box->y = round(y);
+					box->width = round(next_x) - box->x;
+					box->height = round(next_y) - box->y;
+					layout_clamp(&hints[i], &box->width, &box->height);
+					x = next_x + gaps;
+				}
+				y = next_y + gaps;
+			}
+
+			before = row_before;
+			start = end;
+		}
+	}
+
+	double available = area->height - gaps * (rows_used + 1);
+	if (available <= 0) {
+		return INFINITY;
+	}
+
+	return fabs(log(available / natural_height));
+}
+
+static void layout_mosaic_arrange(const struct ptychite_layout_hint *hints, size_t len, const struct wlr_box *area,
+		int gaps, const struct ptychite_layout_params *params, struct wlr_box *boxes) {
+	if (!len) {
+		return;
+	}
+
+	double total = 0;
+	for (size_t i = 0; i < len; i++) {
+		total += mosaic_aspect(&hints[i]);
+	}
+
+	int best_rows = 1;
+	double best_score = INFINITY;
+	for (size_t rows = 1; rows <= len; rows++) {
+		double score = mosaic_arrange_rows(hints, len, area, gaps, rows, total, NULL);
+		if (score < best_score) {
+			best_score = score;
+			best_rows = rows;
+		}
+	}
+
+	mosaic_arrange_rows(hints, len, area, gaps, best_rows, total, boxes);
+}
+
+const struct ptychite_layout ptychite_layout_mosaic = {
+		.name = "mosaic",
+		.arrange = layout_mosaic_arrange,
+};
+
+/* columns continue past the right edge of the area, the caller scrolls them into view */
+static void layout_scrollable_arrange(const struct ptychite_layout_hint *hints, size_t len,
+		const struct wlr_box *area, int gaps, const struct ptychite_layout_params *params, struct wlr_box *boxes) {
+	int column_width = (area->width - gaps) * params->scrollable.column_factor - gaps;
+
+	int x = area->x + gaps;
+	for (size_t i = 0; i < len; i++) {
+		struct wlr_box *box = &boxes[i];
+		box->x = x;
+		box->y = area->y + gaps;
+		box->width = column_width;
+		box->height = area->height - 2 * gaps;
+		layout_clamp(&hints[i], &box->width, &box->height);
+		x += box->width + gaps;
+	}
+}
+
+const struct ptychite_layout ptychite_layout_scrollable = {
+		.name = "scrollable",
+		.arrange = layout_scrollable_arrange,
+};
+
+void ptychite_layout_cache_init(struct ptychite_layout_cache *cache) {
+	cache->layout = NULL;
+	wl_array_init(&cache->hints);
+	wl_array_init(&cache->pending_hints);
+	wl_array_init(&cache->boxes);
+}
+
+void ptychite_layout_cache_finish(struct ptychite_layout_cache *cache) {
+	wl_array_release(&cache->hints);
+	wl_array_release(&cache->pending_hints);
+	wl_array_release(&cache->boxes);
+}
+
+struct ptychite_layout_hint *ptychite_layout_cache_prepare(struct ptychite_layout_cache *cache, size_t len) {
+	cache->pending_hints.size = 0;
+	return wl_array_add(&cache->pending_hints, len * sizeof(struct ptychite_layout_hint));
+}
+
+static bool layout_area_equal(const struct wlr_box *a, const struct wlr_box *b) {
+	return a->x == b->x && a->y == b->y && a->width == b->width && a->height == b->height;
+}
+
+static bool layout_params_equal(const struct ptychite_layout_params *a, const struct ptychite_layout_params *b) {
+	return a->traditional.views_in_master == b->traditional.views_in_master &&
+			a->traditional.master_factor == b->traditional.master_factor &&
+			a->traditional.right_master == b->traditional.right_master &&
+			a->scrollable.column_factor == b->scrollable.column_factor;
+}
+
+const struct wlr_box *ptychite_layout_cache_arrange(struct ptychite_layout_cache *cache,
+		const struct ptychite_layout *layout, size_t len, const struct wlr_box *area, int gaps,
+		const struct ptychite_layout_params *params) {
+	size_t hints_size = len * sizeof(struct ptychite_layout_hint);
+	if (cache->layout == layout && cache->pending_hints.size == hints_size && cache->hints.size == hints_size &&
+			layout_area_equal(&cache->area, area) && cache->gaps == gaps && layout_params_equal(&cache->params, params) &&
+			!memcmp(cache->hints.data, cache->pending_hints.data, hints_size)) {
+		return cache->boxes.data;
+	}
+
+	cache->boxes.size = 0;
+	struct wlr_box *boxes = wl_array_add(&cache->boxes, len * sizeof(struct wlr_box));
+	if (!boxes) {
+		cache->layout = NULL;
+		return NULL;
+	}
+
+	struct wl_array hints = cache->hints;
+	cache->hints = cache->pending_hints;
+	cache->pending_hints = hints;
+
+	cache->layout = layout;
+	cache->area = *area;
+	cache->gaps = gaps;
+	cache->params = *params;
+	layout->arrange(cache->hints.data, len, area, gaps, params, boxes);
+
+	return boxes;
+}
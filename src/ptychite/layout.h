@@ -0,0 +1,56 @@
+#ifndef PTYCHITE_LAYOUT_H
+#define PTYCHITE_LAYOUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <wayland-util.h>
+
+#include <wlr/util/box.h>
+
+/* everything a layout knows about a view, sizes include decorations */
+struct ptychite_layout_hint {
+	int min_width, min_height;
+	int max_width, max_height;
+	double aspect;
+};
+
+struct ptychite_layout_params {
+	struct {
+		int views_in_master;
+		double master_factor;
+		bool right_master;
+	} traditional;
+	struct {
+		double column_factor;
+	} scrollable;
+};
+
+/* layouts are pure: given the same hints, area, gaps and params they must produce the same boxes */
+struct ptychite_layout {
+	const char *name;
+	void (*arrange)(const struct ptychite_layout_hint *hints, size_t len, const struct wlr_box *area, int gaps,
+			const struct ptychite_layout_params *params, struct wlr_box *boxes);
+};
+
+extern const struct ptychite_layout ptychite_layout_traditional;
+extern const struct ptychite_layout ptychite_layout_mosaic;
+extern const struct ptychite_layout ptychite_layout_scrollable;
+
+struct ptychite_layout_cache {
+	const struct ptychite_layout *layout;
+	struct wlr_box area;
+	int gaps;
+	struct ptychite_layout_params params;
+	struct wl_array hints;
+	struct wl_array pending_hints;
+	struct wl_array boxes;
+};
+
+void ptychite_layout_cache_init(struct ptychite_layout_cache *cache);
+void ptychite_layout_cache_finish(struct ptychite_layout_cache *cache);
+struct ptychite_layout_hint *ptychite_layout_cache_prepare(struct ptychite_layout_cache *cache, size_t len);
+const struct wlr_box *ptychite_layout_cache_arrange(struct ptychite_layout_cache *cache,
+		const struct ptychite_layout *layout, size_t len, const struct wlr_box *area, int gaps,
+		const struct ptychite_layout_params *params);
+
+#endif
@@ -109,11 +109,14 @@ static struct json_object *view_describe(struct ptychite_view *view) {
 		return NULL;
 	}
 
+	int x, y;
+	wlr_scene_node_coords(&view->element.scene_tree->node, &x, &y);
+
 	struct json_object *member;
 	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "appid", string, view->xdg_toplevel->app_id)
 	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "title", string, view->xdg_toplevel->title)
-	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "x", int, view->element.scene_tree->node.x)
-	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "y", int, view->element.scene_tree->node.y)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "x", int, x)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "y", int, y)
 	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "width", int, view->element.width)
 	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "height", int, view->element.height)
 
@@ -193,6 +196,283 @@ static void message_dump_views(struct wl_client *client, struct wl_resource *res
 	json_object_put(array);
 }
 
+static struct json_object *launch_stats_describe(struct ptychite_launch_stats *stats) {
+	struct json_object *description = json_object_new_object();
+	if (!description) {
+		return NULL;
+	}
+
+	struct json_object *member;
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "appid", string, stats->app_id)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "count", int, stats->count)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "mean_ms", double, stats->total_ms / stats->count)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "max_ms", double, stats->max_ms)
+
+	struct json_object *histogram = json_object_new_array_ext(PTYCHITE_LAUNCH_HISTOGRAM_BUCKETS);
+	if (!histogram) {
+		json_object_put(description);
+		return NULL;
+	}
+	json_object_object_add(description, "histogram", histogram);
+
+	int i;
+	for (i = 0; i < PTYCHITE_LAUNCH_HISTOGRAM_BUCKETS; i++) {
+		struct json_object *bucket = json_object_new_object();
+		if (!bucket) {
+			json_object_put(description);
+			return NULL;
+		}
+		json_object_array_put_idx(histogram, i, bucket);
+
+		if (i < PTYCHITE_LAUNCH_HISTOGRAM_BUCKETS - 1) {
+			JSON_OBJECT_ADD_MEMBER_OR_RETURN(bucket, member, "below_ms", int, 32 << i)
+		}
+		JSON_OBJECT_ADD_MEMBER_OR_RETURN(bucket, member, "count", int, stats->buckets[i])
+	}
+
+	return description;
+}
+
+static void message_dump_launch_stats(struct wl_client *client, struct wl_resource *resource, uint32_t mode, uint32_t id) {
+	struct wl_resource *callback =
+			wl_resource_create(client, &zptychite_message_callback_v1_interface, wl_resource_get_version(resource), id);
+	if (!callback) {
+		return;
+	}
+
+	struct ptychite_server *server = wl_resource_get_user_data(resource);
+
+	enum ptychite_json_get_mode get_mode;
+	if (protocol_json_get_mode_convert_to_native(mode, &get_mode)) {
+		CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "invalid getting mode");
+		return;
+	}
+
+	struct json_object *array = json_object_new_array_ext(wl_list_length(&server->launch_stats));
+	if (!array) {
+		CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "memory error");
+		return;
+	}
+
+	size_t idx = 0;
+	struct ptychite_launch_stats *stats;
+	wl_list_for_each(stats, &server->launch_stats, link) {
+		struct json_object *description = launch_stats_describe(stats);
+		if (!description) {
+			json_object_put(array);
+			CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "memory error");
+			return;
+		}
+		json_object_array_put_idx(array, idx, description);
+		idx++;
+	}
+
+	char *error;
+	const char *string = ptychite_json_object_convert_to_string(array, get_mode, &error);
+	if (!string) {
+		json_object_put(array);
+		CALLBACK_FAILURE_SEND_AND_DESTROY(callback, error);
+		return;
+	}
+
+	CALLBACK_SUCCESS_SEND_AND_DESTROY(callback, string);
+	json_object_put(array);
+}
+
+static struct json_object *latency_describe(struct ptychite_monitor *monitor) {
+	struct json_object *description = json_object_new_object();
+	if (!description) {
+		return NULL;
+	}
+
+	struct json_object *member;
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "output", string, monitor->output->name)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "samples", int, monitor->latency.samples_us.len)
+
+	uint32_t sorted[PTYCHITE_SAMPLES_MAX];
+	size_t len = ptychite_samples_sort(&monitor->latency.samples_us, sorted);
+	if (!len) {
+		return description;
+	}
+
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(
+			description, member, "p50_ms", double, ptychite_nearest_rank(sorted, len, 50) / 1000.0)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(
+			description, member, "p90_ms", double, ptychite_nearest_rank(sorted, len, 90) / 1000.0)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(
+			description, member, "p99_ms", double, ptychite_nearest_rank(sorted, len, 99) / 1000.0)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "max_ms", double, sorted[len - 1] / 1000.0)
+
+	return description;
+}
+
+static void message_dump_latency(struct wl_client *client, struct wl_resource *resource, uint32_t mode, uint32_t id) {
+	struct wl_resource *callback =
+			wl_resource_create(client, &zptychite_message_callback_v1_interface, wl_resource_get_version(resource), id);
+	if (!callback) {
+		return;
+	}
+
+	struct ptychite_server *server = wl_resource_get_user_data(resource);
+
+	enum ptychite_json_get_mode get_mode;
+	if (protocol_json_get_mode_convert_to_native(mode, &get_mode)) {
+		CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "invalid getting mode");
+		return;
+	}
+
+	struct json_object *array = json_object_new_array_ext(wl_list_length(&server->monitors));
+	if (!array) {
+		CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "memory error");
+		return;
+	}
+
+	size_t idx = 0;
+	struct ptychite_monitor *monitor;
+	wl_list_for_each(monitor, &server->monitors, link) {
+		struct json_object *description = latency_describe(monitor);
+		if (!description) {
+			json_object_put(array);
+			CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "memory error");
+			return;
+		}
+		json_object_array_put_idx(array, idx, description);
+		idx++;
+	}
+
+	char *error;
+	const char *string = ptychite_json_object_convert_to_string(array, get_mode, &error);
+	if (!string) {
+		json_object_put(array);
+		CALLBACK_FAILURE_SEND_AND_DESTROY(callback, error);
+		return;
+	}
+
+	CALLBACK_SUCCESS_SEND_AND_DESTROY(callback, string);
+	json_object_put(array);
+}
+
+static struct json_object *samples_describe(const struct ptychite_samples *samples) {
+	struct json_object *description = json_object_new_object();
+	if (!description) {
+		return NULL;
+	}
+
+	uint32_t sorted[PTYCHITE_SAMPLES_MAX];
+	size_t len = ptychite_samples_sort(samples, sorted);
+
+	struct json_object *member;
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "samples", int, len)
+	if (!len) {
+		return description;
+	}
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(
+			description, member, "p50_ms", double, ptychite_nearest_rank(sorted, len, 50) / 1000.0)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(
+			description, member, "p95_ms", double, ptychite_nearest_rank(sorted, len, 95) / 1000.0)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(
+			description, member, "p99_ms", double, ptychite_nearest_rank(sorted, len, 99) / 1000.0)
+
+	return description;
+}
+
+static struct json_object *frame_stats_describe(struct ptychite_monitor *monitor) {
+	struct json_object *description = json_object_new_object();
+	if (!description) {
+		return NULL;
+	}
+
+	struct json_object *member;
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "output", string, monitor->output->name)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "refresh_mhz", int, monitor->output->refresh)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "frames", int, monitor->stats.frames)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "commits", int, monitor->stats.commits)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "skipped", int, monitor->stats.skipped)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "presented", int, monitor->stats.presented)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "discarded", int, monitor->stats.discarded)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "missed", int, monitor->stats.missed)
+	JSON_OBJECT_ADD_MEMBER_OR_RETURN(description, member, "idle", int, monitor->stats.idle)
+
+	struct {
+		const char *key;
+		const struct ptychite_samples *samples;
+	} rings[] = {
+			{"frame_interval", &monitor->stats.frame_interval_us},
+			{"commit", &monitor->stats.commit_us},
+			{"commit_to_present", &monitor->stats.present_us},
+	};
+	size_t i;
+	for (i = 0; i < LENGTH(rings); i++) {
+		struct json_object *samples = samples_describe(rings[i].samples);
+		if (!samples) {
+			json_object_put(description);
+			return NULL;
+		}
+		json_object_object_add(description, rings[i].key, samples);
+	}
+
+	return description;
+}
+
+static void message_dump_frame_stats(struct wl_client *client, struct wl_resource *resource,
+		struct wl_resource *output_resource, uint32_t mode, uint32_t id) {
+	struct wl_resource *callback =
+			wl_resource_create(client, &zptychite_message_callback_v1_interface, wl_resource_get_version(resource), id);
+	if (!callback) {
+		return;
+	}
+
+	struct ptychite_server *server = wl_resource_get_user_data(resource);
+
+	enum ptychite_json_get_mode get_mode;
+	if (protocol_json_get_mode_convert_to_native(mode, &get_mode)) {
+		CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "invalid getting mode");
+		return;
+	}
+
+	struct ptychite_monitor *only = NULL;
+	if (output_resource) {
+		struct wlr_output *output = wlr_output_from_resource(output_resource);
+		if (!output || !output->data) {
+			CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "unable to obtain wlr_output from resource");
+			return;
+		}
+		only = output->data;
+	}
+
+	struct json_object *array = json_object_new_array();
+	if (!array) {
+		CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "memory error");
+		return;
+	}
+
+	struct ptychite_monitor *monitor;
+	wl_list_for_each(monitor, &server->monitors, link) {
+		if (only && monitor != only) {
+			continue;
+		}
+
+		struct json_object *description = frame_stats_describe(monitor);
+		if (!description || json_object_array_add(array, description)) {
+			json_object_put(description);
+			json_object_put(array);
+			CALLBACK_FAILURE_SEND_AND_DESTROY(callback, "memory error");
+			return;
+		}
+	}
+
+	char *error;
+	const char *string = ptychite_json_object_convert_to_string(array, get_mode, &error);
+	if (!string) {
+		json_object_put(array);
+		CALLBACK_FAILURE_SEND_AND_DESTROY(callback, error);
+		return;
+	}
+
+	CALLBACK_SUCCESS_SEND_AND_DESTROY(callback, string);
+	json_object_put(array);
+}
+
 static void message_destroy(struct wl_client *client, struct wl_resource *resource) {
 	wl_resource_destroy(resource);
 }
@@ -201,6 +481,9 @@ static const struct zptychite_message_v1_interface ptychite_message_impl = {
 		.set_property = message_set_property,
 		.get_property = message_get_property,
 		.dump_views = message_dump_views,
+		.dump_launch_stats = message_dump_launch_stats,
+		.dump_latency = message_dump_latency,
+		.dump_frame_stats = message_dump_frame_stats,
 		.destroy = message_destroy,
 };
 
@@ -218,5 +501,5 @@ static void message_handle_bind(struct wl_client *client, void *data, uint32_t v
 }
 
 void ptychite_setup_message_proto(struct ptychite_server *server) {
-	wl_global_create(server->display, &zptychite_message_v1_interface, 1, server, message_handle_bind);
+	wl_global_create(server->display, &zptychite_message_v1_interface, 4, server, message_handle_bind);
 }
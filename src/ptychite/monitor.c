@@ -1,3 +1,7 @@
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
 #include "compositor.h"
 #include "config.h"
 #include "monitor.h"
@@ -13,71 +17,174 @@ struct ptychite_workspace *ptychite_monitor_add_workspace(struct ptychite_monito
 
 	wl_list_init(&workspace->views_order);
 	wl_list_init(&workspace->views_focus);
-	workspace->tiling.traditional.views_in_master = 1;
-	workspace->tiling.traditional.master_factor = 0.55;
-	workspace->tiling.traditional.right_master = false;
+	ptychite_layout_cache_init(&workspace->tiling.cache);
+	workspace->tiling.params.traditional.views_in_master = 1;
+	workspace->tiling.params.traditional.master_factor = 0.55;
+	workspace->tiling.params.traditional.right_master = false;
+	workspace->tiling.params.scrollable.column_factor = 0.5;
 
 	wl_list_insert(monitor->workspaces.prev, &workspace->link);
 
 	return workspace;
 }
 
+static void workspace_destroy(struct ptychite_workspace *workspace) {
+	ptychite_layout_cache_finish(&workspace->tiling.cache);
+	free(workspace);
+}
+
+static void monitor_set_view_offscreen(struct ptychite_view *view, bool offscreen) {
+	if (view->offscreen == offscreen) {
+		return;
+	}
+
+	view->offscreen = offscreen;
+	wlr_scene_node_set_enabled(&view->element.scene_tree->node, !offscreen);
+
+	/* a view scrolling back in is resumed right away so that it has drawn by the time it shows, whether it is
+	 * covered is left to the next suspend check */
+	if (view->suspended != offscreen) {
+		view->suspended = offscreen;
+		wlr_xdg_toplevel_set_suspended(view->xdg_toplevel, offscreen);
+	}
+}
+
+static void monitor_scroll_to_focus(
+		struct ptychite_monitor *monitor, struct ptychite_workspace *workspace, const struct wlr_box *boxes, int gaps) {
+	struct wlr_box *area = &monitor->window_geometry;
+	struct ptychite_view *focused_view = wl_container_of(workspace->views_focus.next, focused_view, workspace_focus_link);
+
+	size_t i = 0;
+	const struct wlr_box *last = NULL;
+	const struct wlr_box *focused = NULL;
+	struct ptychite_view *view;
+	wl_list_for_each(view, &workspace->views_order, workspace_order_link) {
+		if (view == focused_view) {
+			focused = &boxes[i];
+		}
+		last = &boxes[i++];
+	}
+
+	int scroll = workspace->tiling.scroll;
+	if (focused) {
+		if (focused->x + focused->width + gaps - scroll > area->x + area->width) {
+			scroll = focused->x + focused->width + gaps - area->x - area->width;
+		}
+		if (focused->x - gaps - scroll < area->x) {
+			scroll = focused->x - gaps - area->x;
+		}
+	}
+
+	int max_scroll = last->x + last->width + gaps - area->x - area->width;
+	if (scroll > max_scroll) {
+		scroll = max_scroll;
+	}
+	if (scroll < 0) {
+		scroll = 0;
+	}
+	workspace->tiling.scroll = scroll;
+}
+
 void ptychite_monitor_tile(struct ptychite_monitor *monitor) {
+	monitor->needs_tile = true;
+	ptychite_server_schedule_flush(monitor->server);
+}
+
+void ptychite_monitor_tile_now(struct ptychite_monitor *monitor) {
+	monitor->needs_tile = false;
+
 	struct ptychite_workspace *workspace = monitor->current_workspace;
 	if (wl_list_empty(&workspace->views_order)) {
 		return;
 	}
 
 	struct ptychite_config *config = monitor->server->compositor->config;
-	int gaps = config->tiling.gaps;
+	bool scrollable = config->tiling.mode == PTYCHITE_TILING_SCROLLABLE;
+	wlr_scene_node_set_position(&monitor->scene_tree->node, scrollable ? -workspace->tiling.scroll : 0, 0);
+
+	struct ptychite_view *view;
+	if (config->tiling.mode == PTYCHITE_TILING_NONE) {
+		wl_list_for_each(view, &workspace->views_order, workspace_order_link) {
+			monitor_set_view_offscreen(view, false);
+		}
+		ptychite_server_check_cursor(monitor->server);
+		return;
+	}
 
+	const struct ptychite_layout *layout;
 	switch (config->tiling.mode) {
-	case PTYCHITE_TILING_NONE:
+	case PTYCHITE_TILING_MOSAIC:
+		layout = &ptychite_layout_mosaic;
 		break;
-	case PTYCHITE_TILING_TRADITIONAL: {
-		int views_len = wl_list_length(&workspace->views_order);
-		int views_in_master = workspace->tiling.traditional.views_in_master;
-		double master_factor = workspace->tiling.traditional.master_factor;
-		bool right_master = workspace->tiling.traditional.right_master;
-
-		int master_width;
-		if (views_len > views_in_master) {
-			master_width = views_in_master ? (monitor->window_geometry.width + gaps) * master_factor : 0;
-		} else {
-			master_width = monitor->window_geometry.width - gaps;
+	case PTYCHITE_TILING_SCROLLABLE:
+		layout = &ptychite_layout_scrollable;
+		break;
+	case PTYCHITE_TILING_TRADITIONAL:
+	default:
+		layout = &ptychite_layout_traditional;
+		break;
+	}
+
+	/* the layout only sees size constraints, so it can be cached and rerun without touching any views */
+	size_t views_len = wl_list_length(&workspace->views_order);
+	struct ptychite_layout_hint *hints = ptychite_layout_cache_prepare(&workspace->tiling.cache, views_len);
+	if (!hints) {
+		return;
+	}
+
+	size_t i = 0;
+	wl_list_for_each(view, &workspace->views_order, workspace_order_link) {
+		struct ptychite_layout_hint *hint = &hints[i++];
+		hint->min_width = hint->min_height = 0;
+		ptychite_view_clamp_size(view, &hint->min_width, &hint->min_height);
+		hint->max_width = hint->max_height = INT_MAX;
+		ptychite_view_clamp_size(view, &hint->max_width, &hint->max_height);
+		hint->aspect = view->initial_height > 0 ? (double)view->initial_width / view->initial_height : 0;
+	}
+
+	const struct wlr_box *boxes = ptychite_layout_cache_arrange(&workspace->tiling.cache, layout, views_len,
+			&monitor->window_geometry, config->tiling.gaps, &workspace->tiling.params);
+	if (!boxes) {
+		return;
+	}
+
+	/* scrolling only moves the monitor tree, views that end up entirely outside the monitor are disabled so
+	 * that they are neither rendered nor sent frame callbacks */
+	bool changed = false;
+	if (scrollable) {
+		int scroll = workspace->tiling.scroll;
+		monitor_scroll_to_focus(monitor, workspace, boxes, config->tiling.gaps);
+		if (scroll != workspace->tiling.scroll) {
+			wlr_scene_node_set_position(&monitor->scene_tree->node, -workspace->tiling.scroll, 0);
+			changed = true;
 		}
+	}
 
-		int master_x =
-				monitor->window_geometry.x + (right_master ? monitor->window_geometry.width - master_width : gaps);
-		int stack_x = monitor->window_geometry.x + (right_master ? gaps : master_width + gaps);
-		int master_y = gaps;
-		int stack_y = gaps;
-		int i = 0;
-		struct ptychite_view *view;
-		wl_list_for_each(view, &workspace->views_order, workspace_order_link) {
-			if (i < views_in_master) {
-				int r = fmin(views_len, views_in_master) - i;
-				int height = (monitor->window_geometry.height - master_y - gaps * r) / r;
-				wlr_scene_node_set_position(
-						&view->element.scene_tree->node, master_x, monitor->window_geometry.y + master_y);
-				ptychite_view_resize(view, master_width - gaps, height);
-				master_y += view->element.height + gaps;
-			} else {
-				int r = views_len - i;
-				int height = (monitor->window_geometry.height - stack_y - gaps * r) / r;
-				wlr_scene_node_set_position(
-						&view->element.scene_tree->node, stack_x, monitor->window_geometry.y + stack_y);
-				ptychite_view_resize(view, monitor->window_geometry.width - master_width - 2 * gaps, height);
-				stack_y += view->element.height + gaps;
-			}
-			i++;
+	i = 0;
+	wl_list_for_each(view, &workspace->views_order, workspace_order_link) {
+		const struct wlr_box *box = &boxes[i++];
+		struct wlr_scene_node *node = &view->element.scene_tree->node;
+
+		bool offscreen = scrollable && (box->x + box->width - workspace->tiling.scroll <= monitor->geometry.x ||
+												box->x - workspace->tiling.scroll >= monitor->geometry.x + monitor->geometry.width);
+		if (offscreen != view->offscreen) {
+			monitor_set_view_offscreen(view, offscreen);
+			changed = true;
 		}
 
-		break;
-	}
+		if (node->x != box->x || node->y != box->y) {
+			wlr_scene_node_set_position(node, box->x, box->y);
+			changed = true;
+		}
+		if (view->element.width != box->width || view->element.height != box->height) {
+			ptychite_view_resize(view, box->width, box->height);
+			changed = true;
+		}
 	}
 
-	ptychite_server_check_cursor(monitor->server);
+	if (changed) {
+		ptychite_server_check_cursor(monitor->server);
+	}
 }
 
 void ptychite_monitor_fix_workspaces(struct ptychite_monitor *monitor) {
@@ -93,7 +200,7 @@ void ptychite_monitor_fix_workspaces(struct ptychite_monitor *monitor) {
 		}
 		if (wl_list_empty(&workspace->views_order)) {
 			wl_list_remove(&workspace->link);
-			free(workspace);
+			workspace_destroy(workspace);
 		}
 	}
 }
@@ -105,10 +212,12 @@ void ptychite_monitor_switch_workspace(struct ptychite_monitor *monitor, struct
 	struct ptychite_view *view;
 	wl_list_for_each(view, &last_workspace->views_order, workspace_order_link) {
 		wlr_scene_node_set_enabled(&view->element.scene_tree->node, false);
+		ptychite_view_clear_pending_resize(view);
 	}
 	wl_list_for_each(view, &monitor->current_workspace->views_order, workspace_order_link) {
-		wlr_scene_node_set_enabled(&view->element.scene_tree->node, true);
+		wlr_scene_node_set_enabled(&view->element.scene_tree->node, !view->offscreen);
 	}
+	ptychite_monitor_tile(monitor);
 
 	ptychite_monitor_fix_workspaces(monitor);
 	if (monitor->panel && monitor->panel->base.element.scene_tree->node.enabled) {
@@ -136,6 +245,11 @@ void ptychite_monitor_switch_workspace(struct ptychite_monitor *monitor, struct
 void ptychite_monitor_disable(struct ptychite_monitor *monitor) {
 	struct ptychite_server *server = monitor->server;
 
+	if (monitor->render.scheduled) {
+		monitor->render.scheduled = false;
+		wl_event_source_timer_update(monitor->render.timer, 0);
+	}
+
 	if (monitor == server->active_monitor) {
 		server->active_monitor = NULL;
 		struct ptychite_monitor *iter;
@@ -158,11 +272,17 @@ void ptychite_monitor_disable(struct ptychite_monitor *monitor) {
 				break;
 			}
 			wl_list_remove(&workspace->link);
-			free(workspace);
+			workspace_destroy(workspace);
 		}
 
 		struct ptychite_view *view, *view_tmp;
 		wl_list_for_each_safe(view, view_tmp, &monitor->views, monitor_link) {
+			ptychite_view_clear_pending_resize(view);
+			view->monitor = server->active_monitor;
+			view->workspace = server->active_monitor->current_workspace;
+			wlr_scene_node_reparent(&view->element.scene_tree->node, server->active_monitor->scene_tree);
+			view->offscreen = false;
+			wlr_scene_node_set_enabled(&view->element.scene_tree->node, true);
 			wl_list_insert(&server->active_monitor->views, &view->monitor_link);
 			wl_list_insert(&server->active_monitor->current_workspace->views_order, &view->workspace_order_link);
 			wl_list_insert(server->active_monitor->current_workspace->views_focus.prev, &view->workspace_focus_link);
@@ -173,35 +293,320 @@ void ptychite_monitor_disable(struct ptychite_monitor *monitor) {
 	}
 }
 
+static int monitor_handle_transaction_timeout(void *data) {
+	struct ptychite_monitor *monitor = data;
+	monitor->transaction.pending = false;
+
+	/* whoever has not acked by now is shown at its old size inside the new geometry rather than holding up the
+	 * whole output */
+	struct ptychite_view *view, *view_tmp;
+	wl_list_for_each_safe(view, view_tmp, &monitor->pending_resizes, pending_resize_link) {
+		wlr_log(WLR_DEBUG, "Configure timeout for '%s' on %s, applying layout without it",
+				view->xdg_toplevel->app_id ? view->xdg_toplevel->app_id : "", monitor->output->name);
+		ptychite_view_clear_pending_resize(view);
+	}
+
+	wlr_output_schedule_frame(monitor->output);
+
+	return 0;
+}
+
+void ptychite_monitor_begin_transaction(struct ptychite_monitor *monitor) {
+	if (monitor->transaction.pending) {
+		return;
+	}
+
+	monitor->transaction.pending = true;
+	wl_event_source_timer_update(
+			monitor->transaction.timeout, monitor->server->compositor->config->views.configure_timeout);
+}
+
+static void monitor_render(struct ptychite_monitor *monitor, bool send_frame_done) {
+	struct timespec start, now;
+
+	if (monitor->needs_tile) {
+		ptychite_monitor_tile_now(monitor);
+	}
+
+	struct wlr_scene_output *scene_output = wlr_scene_get_scene_output(monitor->server->scene, monitor->output);
+
+	/* geometry changes are already in the scene graph, holding back the commit until every affected client has
+	 * acked its configure (or the transaction timed out) presents them all in one frame */
+	if (!wl_list_empty(&monitor->pending_resizes)) {
+		ptychite_monitor_begin_transaction(monitor);
+		monitor->stats.skipped++;
+		goto skip;
+	}
+
+	if (monitor->transaction.pending) {
+		monitor->transaction.pending = false;
+		wl_event_source_timer_update(monitor->transaction.timeout, 0);
+	}
+
+	ptychite_hud_capture_damage(&monitor->server->hud, monitor);
+
+	uint32_t commit_seq = monitor->output->commit_seq;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	wlr_scene_output_commit(scene_output, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	if (monitor->output->commit_seq != commit_seq) {
+		ptychite_samples_push_ms(&monitor->stats.commit_us, ptychite_timespec_diff_ms(&start, &now));
+		monitor->stats.commits++;
+		monitor->stats.last_commit = now;
+		monitor->stats.last_commit_seq = monitor->output->commit_seq;
+	}
+
+	if (monitor->latency.input_pending) {
+		/* only a commit carrying a change the input caused is linked to it. the client may not have redrawn yet
+		 * when the first frame after an input comes, so the input waits, and one that never caused anything, like a
+		 * key without visual effect or hardware cursor motion, is dropped after a second instead of being charged
+		 * to whatever unrelated commit comes next */
+		double input_age = ptychite_timespec_diff_ms(&monitor->latency.input, &now);
+		if (monitor->output->commit_seq != commit_seq && monitor->latency.input_responded &&
+				!monitor->latency.commit_pending && input_age < 1000) {
+			monitor->latency.committed_input = monitor->latency.input;
+			monitor->latency.commit_seq = monitor->output->commit_seq;
+			monitor->latency.commit_pending = true;
+			monitor->latency.input_pending = false;
+		} else if (input_age >= 1000) {
+			monitor->latency.input_pending = false;
+		}
+	}
+
+	if (send_frame_done) {
+		wlr_scene_output_send_frame_done(scene_output, &now);
+	}
+	return;
+
+skip:
+	if (send_frame_done) {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		wlr_scene_output_send_frame_done(scene_output, &now);
+	}
+}
+
+static int monitor_get_max_render_time(struct ptychite_monitor *monitor) {
+	struct ptychite_config *config = monitor->server->compositor->config;
+
+	struct ptychite_output_config *output;
+	wl_array_for_each(output, &config->monitors.outputs) {
+		if (!strcmp(output->name, monitor->output->name)) {
+			return output->max_render_time;
+		}
+	}
+
+	return config->monitors.max_render_time;
+}
+
+/* how long the commit can wait and still make the next vblank, which is predicted from the last present and the
+ * refresh rate, leaving either the configured render time or the measured 99th percentile plus a margin */
+static int monitor_predict_render_delay(struct ptychite_monitor *monitor, const struct timespec *now) {
+	int max_render_time = monitor_get_max_render_time(monitor);
+	if (!max_render_time || monitor->output->refresh <= 0 || !monitor->render.last_present.tv_sec ||
+			monitor->output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED) {
+		return 0;
+	}
+
+	double render_ms = max_render_time;
+	if (max_render_time == PTYCHITE_MAX_RENDER_TIME_AUTO) {
+		if (monitor->stats.commit_us.len < 16) {
+			return 0;
+		}
+
+		uint32_t sorted[PTYCHITE_SAMPLES_MAX];
+		size_t len = ptychite_samples_sort(&monitor->stats.commit_us, sorted);
+		render_ms = ptychite_nearest_rank(sorted, len, 99) / 1000.0 + 1;
+	}
+
+	double refresh_ms = 1000000.0 / monitor->output->refresh;
+	double since_present_ms = ptychite_timespec_diff_ms(&monitor->render.last_present, now);
+	double delay_ms = refresh_ms - fmod(fmax(since_present_ms, 0), refresh_ms) - render_ms;
+
+	return delay_ms >= 1 ? delay_ms : 0;
+}
+
+static int monitor_handle_render_timer(void *data) {
+	struct ptychite_monitor *monitor = data;
+
+	monitor->render.scheduled = false;
+	monitor_render(monitor, false);
+
+	return 0;
+}
+
 static void monitor_handle_frame(struct wl_listener *listener, void *data) {
+	struct ptychite_monitor *monitor = wl_container_of(listener, monitor, frame);
+	if (monitor->power.off) {
+		return;
+	}
+
+	ptychite_server_flush_cursor_motion(monitor->server);
+
+	/* without a pending page flip, damage during the delay fires more frame events, the armed commit covers them,
+	 * so they are not frames of their own either */
+	if (monitor->render.scheduled) {
+		return;
+	}
+
 	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	/* frames only come on damage, so a gap of several refreshes is the output sitting idle rather than a slow frame,
+	 * and is counted as such instead of being sampled */
+	if (monitor->stats.frames++) {
+		double interval_ms = ptychite_timespec_diff_ms(&monitor->stats.last_frame, &now);
+		double refresh_ms = monitor->output->refresh > 0 ? 1000000.0 / monitor->output->refresh : 1000.0 / 60;
+		if (interval_ms > 4 * refresh_ms) {
+			monitor->stats.idle++;
+		} else {
+			ptychite_samples_push_ms(&monitor->stats.frame_interval_us, interval_ms);
+		}
+	}
+	monitor->stats.last_frame = now;
 
-	struct ptychite_monitor *monitor = wl_container_of(listener, monitor, frame);
-	struct wlr_scene_output *scene_output = wlr_scene_get_scene_output(monitor->server->scene, monitor->output);
+	int delay = monitor_predict_render_delay(monitor, &now);
+	if (!delay) {
+		monitor_render(monitor, true);
+		return;
+	}
 
-	struct ptychite_monitor *monitor_iter;
-	wl_list_for_each(monitor_iter, &monitor->server->monitors, link) {
-		struct ptychite_view *view;
-		wl_list_for_each(view, &monitor_iter->current_workspace->views_order, workspace_order_link) {
-			if (!view->resize_serial || view == monitor->server->grabbed_view ||
-					!view->element.scene_tree->node.enabled) {
-				continue;
-			}
+	/* clients are released right away so that what they draw during the delay still makes it into this frame */
+	wlr_scene_output_send_frame_done(wlr_scene_get_scene_output(monitor->server->scene, monitor->output), &now);
+	monitor->render.scheduled = true;
+	wl_event_source_timer_update(monitor->render.timer, delay);
+}
+
+int ptychite_monitor_init_timers(struct ptychite_monitor *monitor, struct wl_event_loop *event_loop) {
+	monitor->transaction.pending = false;
+	if (!(monitor->transaction.timeout =
+						wl_event_loop_add_timer(event_loop, monitor_handle_transaction_timeout, monitor))) {
+		return -1;
+	}
+
+	monitor->render.scheduled = false;
+	if (!(monitor->render.timer = wl_event_loop_add_timer(event_loop, monitor_handle_render_timer, monitor))) {
+		wl_event_source_remove(monitor->transaction.timeout);
+		return -1;
+	}
+
+	return 0;
+}
+
+void ptychite_monitor_init_stats(struct ptychite_monitor *monitor) {
+	ptychite_samples_init(&monitor->stats.frame_interval_us, PTYCHITE_FRAME_SAMPLES);
+	ptychite_samples_init(&monitor->stats.commit_us, PTYCHITE_FRAME_SAMPLES);
+	ptychite_samples_init(&monitor->stats.present_us, PTYCHITE_FRAME_SAMPLES);
+	ptychite_samples_init(&monitor->latency.samples_us, PTYCHITE_LATENCY_SAMPLES);
+}
+
+static void monitor_handle_present(struct wl_listener *listener, void *data) {
+	struct ptychite_monitor *monitor = wl_container_of(listener, monitor, present);
+	struct wlr_output_event_present *event = data;
+
+	if (event->presented && event->when) {
+		monitor->render.last_present = *event->when;
+	}
 
-			struct wlr_surface_output *surface_output;
-			wl_list_for_each(surface_output, &view->xdg_toplevel->base->surface->current_outputs, link) {
-				if (surface_output->output == monitor->output) {
-					goto skip;
-				}
+	if (event->commit_seq == monitor->stats.last_commit_seq) {
+		if (event->presented && event->when) {
+			/* a commit shows at the vblank after it, anything past one and a half refreshes means it missed one */
+			double present_ms = ptychite_timespec_diff_ms(&monitor->stats.last_commit, event->when);
+			ptychite_samples_push_ms(&monitor->stats.present_us, present_ms);
+			monitor->stats.presented++;
+			if (monitor->output->refresh > 0 && present_ms > 1.5 * 1000000.0 / monitor->output->refresh) {
+				monitor->stats.missed++;
 			}
+		} else {
+			monitor->stats.discarded++;
 		}
 	}
 
-	wlr_scene_output_commit(scene_output, NULL);
+	if (!monitor->latency.commit_pending || event->commit_seq != monitor->latency.commit_seq) {
+		return;
+	}
+	monitor->latency.commit_pending = false;
 
-skip:
+	if (!event->presented || !event->when) {
+		return;
+	}
+
+	double latency_ms = ptychite_timespec_diff_ms(&monitor->latency.committed_input, event->when);
+	if (latency_ms < 0) {
+		return;
+	}
+
+	ptychite_samples_push_ms(&monitor->latency.samples_us, latency_ms);
+}
+
+void ptychite_monitor_stamp_input(struct ptychite_monitor *monitor) {
+	/* only the oldest input since the last commit is kept, the latency of a burst is that of its first event. one
+	 * that nothing responded to within two refreshes, like pointer motion before a click, is replaced so that the
+	 * input which does cause a change is not charged for the wait */
+	struct timespec now;
 	clock_gettime(CLOCK_MONOTONIC, &now);
-	wlr_scene_output_send_frame_done(scene_output, &now);
+	if (monitor->latency.input_pending) {
+		double input_age = ptychite_timespec_diff_ms(&monitor->latency.input, &now);
+		double refresh_ms = monitor->output->refresh > 0 ? 1000000.0 / monitor->output->refresh : 1000.0 / 60;
+		if (input_age < 1000 && (monitor->latency.input_responded || input_age < 2 * refresh_ms)) {
+			return;
+		}
+	}
+
+	monitor->latency.input = now;
+	monitor->latency.input_pending = true;
+	monitor->latency.input_responded = false;
+}
+
+void ptychite_monitor_note_input_response(struct ptychite_monitor *monitor) {
+	if (monitor->latency.input_pending) {
+		monitor->latency.input_responded = true;
+	}
+}
+
+bool ptychite_monitor_set_power(struct ptychite_monitor *monitor, bool on) {
+	struct wlr_output *output = monitor->output;
+	if (on ? !monitor->power.off : !output->enabled) {
+		return true;
+	}
+
+	struct wlr_output_state state;
+	wlr_output_state_init(&state);
+	wlr_output_state_set_enabled(&state, on);
+	if (!on) {
+		monitor->power.mode = output->current_mode;
+		monitor->power.width = output->width;
+		monitor->power.height = output->height;
+		monitor->power.refresh = output->refresh;
+	} else if (monitor->power.mode) {
+		wlr_output_state_set_mode(&state, monitor->power.mode);
+	} else if (monitor->power.width) {
+		wlr_output_state_set_custom_mode(
+				&state, monitor->power.width, monitor->power.height, monitor->power.refresh);
+	}
+
+	bool ok = wlr_output_commit_state(output, &state);
+	wlr_output_state_finish(&state);
+	if (!ok) {
+		return false;
+	}
+
+	monitor->power.off = !on;
+	if (!on && monitor->render.scheduled) {
+		monitor->render.scheduled = false;
+		wl_event_source_timer_update(monitor->render.timer, 0);
+	}
+
+	return true;
+}
+
+/* anything that enables the output, such as an output management client, also powers it back on */
+static void monitor_handle_commit(struct wl_listener *listener, void *data) {
+	struct ptychite_monitor *monitor = wl_container_of(listener, monitor, commit);
+
+	if (monitor->power.off && monitor->output->enabled) {
+		monitor->power.off = false;
+		ptychite_server_update_power(monitor->server);
+	}
 }
 
 static void monitor_handle_request_state(struct wl_listener *listener, void *data) {
@@ -215,6 +620,8 @@ static void monitor_handle_destroy(struct wl_listener *listener, void *data) {
 	struct ptychite_monitor *monitor = wl_container_of(listener, monitor, destroy);
 
 	wl_list_remove(&monitor->frame.link);
+	wl_list_remove(&monitor->present.link);
+	wl_list_remove(&monitor->commit.link);
 	wl_list_remove(&monitor->request_state.link);
 	wl_list_remove(&monitor->destroy.link);
 	wl_list_remove(&monitor->link);
@@ -229,9 +636,27 @@ static void monitor_handle_destroy(struct wl_listener *listener, void *data) {
 	}
 
 	ptychite_monitor_disable(monitor);
-	struct ptychite_workspace *workspace;
-	wl_list_for_each(workspace, &monitor->workspaces, link) {
-		free(workspace);
+	ptychite_hud_forget_monitor(&monitor->server->hud, monitor);
+	wl_event_source_remove(monitor->transaction.timeout);
+	wl_event_source_remove(monitor->render.timer);
+	struct ptychite_view *view, *view_tmp;
+	wl_list_for_each_safe(view, view_tmp, &monitor->pending_resizes, pending_resize_link) {
+		ptychite_view_clear_pending_resize(view);
+	}
+	if (!monitor->server->terminated) {
+		wl_list_for_each(view, &monitor->views, monitor_link) {
+			wlr_scene_node_reparent(&view->element.scene_tree->node, monitor->server->layers.tiled);
+		}
+		wlr_scene_node_destroy(&monitor->scene_tree->node);
+		ptychite_server_invalidate_hit_grids(monitor->server);
+		ptychite_server_queue_output_profile(monitor->server);
+		ptychite_server_update_power(monitor->server);
+	}
+	ptychite_hit_grid_finish(&monitor->hit_grid);
+
+	struct ptychite_workspace *workspace, *workspace_tmp;
+	wl_list_for_each_safe(workspace, workspace_tmp, &monitor->workspaces, link) {
+		workspace_destroy(workspace);
 	}
 
 	free(monitor);
@@ -240,6 +665,10 @@ static void monitor_handle_destroy(struct wl_listener *listener, void *data) {
 void ptychite_monitor_rig(struct ptychite_monitor *monitor) {
 	monitor->frame.notify = monitor_handle_frame;
 	wl_signal_add(&monitor->output->events.frame, &monitor->frame);
+	monitor->present.notify = monitor_handle_present;
+	wl_signal_add(&monitor->output->events.present, &monitor->present);
+	monitor->commit.notify = monitor_handle_commit;
+	wl_signal_add(&monitor->output->events.commit, &monitor->commit);
 	monitor->request_state.notify = monitor_handle_request_state;
 	wl_signal_add(&monitor->output->events.request_state, &monitor->request_state);
 	monitor->destroy.notify = monitor_handle_destroy;
@@ -1,8 +1,15 @@
 #ifndef PTYCHITE_MONITOR_H
 #define PTYCHITE_MONITOR_H
 
+#include <time.h>
+
+#include "grid.h"
+#include "layout.h"
 #include "util.h"
 
+#define PTYCHITE_LATENCY_SAMPLES 512
+#define PTYCHITE_FRAME_SAMPLES 256
+
 struct ptychite_monitor {
 	struct wl_list link;
 	struct ptychite_server *server;
@@ -14,8 +21,60 @@ struct ptychite_monitor {
 	struct ptychite_workspace *current_workspace;
 	struct ptychite_wallpaper *wallpaper;
 	struct ptychite_panel *panel;
+	struct wlr_scene_tree *scene_tree;
+	bool needs_tile;
+	struct wl_list pending_resizes;
+	struct ptychite_hit_grid hit_grid;
+
+	/* what the monitor was last laid out with, layout changes only touch monitors that differ from it */
+	struct {
+		bool enabled;
+		float scale;
+		int32_t refresh;
+		int transform;
+	} applied;
+
+	struct {
+		struct wl_event_source *timeout;
+		bool pending;
+	} transaction;
+
+	struct {
+		struct wl_event_source *timer;
+		bool scheduled;
+		struct timespec last_present;
+	} render;
+
+	struct {
+		struct timespec last_frame;
+		struct timespec last_commit;
+		uint32_t last_commit_seq;
+		struct ptychite_samples frame_interval_us;
+		struct ptychite_samples commit_us;
+		struct ptychite_samples present_us;
+		uint32_t frames, commits, skipped, presented, discarded, missed, idle;
+	} stats;
+
+	/* a powered off output is disabled, but keeps its place in the layout and its views */
+	struct {
+		bool off;
+		struct wlr_output_mode *mode;
+		int32_t width, height, refresh;
+	} power;
+
+	struct {
+		struct timespec input;
+		bool input_pending;
+		bool input_responded;
+		struct timespec committed_input;
+		uint32_t commit_seq;
+		bool commit_pending;
+		struct ptychite_samples samples_us;
+	} latency;
 
 	struct wl_listener frame;
+	struct wl_listener present;
+	struct wl_listener commit;
 	struct wl_listener request_state;
 	struct wl_listener destroy;
 };
@@ -25,20 +84,25 @@ struct ptychite_workspace {
 	struct wl_list views_order;
 	struct wl_list views_focus;
 	struct {
-		struct {
-			int views_in_master;
-			double master_factor;
-			bool right_master;
-		} traditional;
+		struct ptychite_layout_params params;
+		struct ptychite_layout_cache cache;
+		int scroll;
 	} tiling;
 	struct ptychite_mouse_region region;
 };
 
 struct ptychite_workspace *ptychite_monitor_add_workspace(struct ptychite_monitor *monitor);
 void ptychite_monitor_tile(struct ptychite_monitor *monitor);
+void ptychite_monitor_tile_now(struct ptychite_monitor *monitor);
 void ptychite_monitor_switch_workspace(struct ptychite_monitor *monitor, struct ptychite_workspace *workspace);
 void ptychite_monitor_fix_workspaces(struct ptychite_monitor *monitor);
 void ptychite_monitor_disable(struct ptychite_monitor *monitor);
+int ptychite_monitor_init_timers(struct ptychite_monitor *monitor, struct wl_event_loop *event_loop);
+void ptychite_monitor_init_stats(struct ptychite_monitor *monitor);
+void ptychite_monitor_begin_transaction(struct ptychite_monitor *monitor);
+void ptychite_monitor_stamp_input(struct ptychite_monitor *monitor);
+void ptychite_monitor_note_input_response(struct ptychite_monitor *monitor);
+bool ptychite_monitor_set_power(struct ptychite_monitor *monitor, bool on);
 void ptychite_monitor_rig(struct ptychite_monitor *monitor);
 
 #endif
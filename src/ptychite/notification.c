@@ -86,6 +86,7 @@ void ptychite_notification_destroy(struct ptychite_notification *notif) {
 	ptychite_notification_reset(notif);
 
 	wlr_scene_node_destroy(&notif->base.element.scene_tree->node);
+	ptychite_server_invalidate_hit_grids(notif->base.server);
 
 	free(notif->app_name);
 	free(notif->app_icon);
@@ -110,6 +111,7 @@ void ptychite_notification_close(
 	}
 
 	wlr_scene_node_set_enabled(&notif->base.element.scene_tree->node, false);
+	ptychite_server_invalidate_hit_grids(notif->server);
 
 	if (add_to_history) {
 		wl_list_insert(&notif->server->notifications.history, &notif->link);
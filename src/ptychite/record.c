@@ -0,0 +1,560 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wayland-server-core.h>
+#include <wayland-util.h>
+
+#include <wlr/backend.h>
+#include <wlr/interfaces/wlr_keyboard.h>
+#include <wlr/interfaces/wlr_pointer.h>
+#include <wlr/util/log.h>
+
+#include "record.h"
+#include "server.h"
+#include "util.h"
+
+struct recorder_device {
+	struct wl_list link;
+	struct ptychite_recorder *recorder;
+	struct wlr_input_device *device;
+	uint8_t id;
+
+	struct wl_listener destroy;
+};
+
+struct ptychite_recorder {
+	FILE *file;
+	struct wl_list devices;
+	unsigned int next_device;
+	/* the cursor does not say which pointer a frame belongs to, it ends the events of the last one */
+	int last_pointer;
+};
+
+static uint32_t record_now_msec(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint32_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static void recorder_write_bytes(struct ptychite_recorder *recorder, const void *data, size_t size) {
+	if (!recorder->file) {
+		return;
+	}
+
+	if (fwrite(data, size, 1, recorder->file) != 1) {
+		wlr_log(WLR_ERROR, "Could not write input recording, stopping it");
+		fclose(recorder->file);
+		recorder->file = NULL;
+	}
+}
+
+static void recorder_write(struct ptychite_recorder *recorder, const struct ptychite_record_event *event) {
+	recorder_write_bytes(recorder, event, sizeof(struct ptychite_record_event));
+
+	/* a crash is exactly what a recording is wanted for, so it is flushed at every key and at the frame that ends
+	 * each batch of pointer events, rather than only at exit */
+	if (recorder->file && event->type != PTYCHITE_RECORD_MOTION && event->type != PTYCHITE_RECORD_MOTION_ABSOLUTE &&
+			event->type != PTYCHITE_RECORD_AXIS && event->type != PTYCHITE_RECORD_BUTTON) {
+		fflush(recorder->file);
+	}
+}
+
+static struct recorder_device *recorder_find_device(
+		struct ptychite_recorder *recorder, struct wlr_input_device *device) {
+	struct recorder_device *r_device;
+	wl_list_for_each(r_device, &recorder->devices, link) {
+		if (r_device->device == device) {
+			if (device->type == WLR_INPUT_DEVICE_POINTER) {
+				recorder->last_pointer = r_device->id;
+			}
+			return r_device;
+		}
+	}
+
+	return NULL;
+}
+
+static void recorder_device_destroy(struct recorder_device *r_device) {
+	wl_list_remove(&r_device->link);
+	wl_list_remove(&r_device->destroy.link);
+	free(r_device);
+}
+
+static void recorder_device_handle_destroy(struct wl_listener *listener, void *data) {
+	struct recorder_device *r_device = wl_container_of(listener, r_device, destroy);
+
+	if (r_device->recorder->last_pointer == r_device->id) {
+		r_device->recorder->last_pointer = -1;
+	}
+
+	recorder_write(r_device->recorder, &(struct ptychite_record_event){
+			.type = PTYCHITE_RECORD_DEVICE_REMOVE,
+			.device = r_device->id,
+			.time_msec = record_now_msec(),
+	});
+
+	recorder_device_destroy(r_device);
+}
+
+struct ptychite_recorder *ptychite_recorder_create(const char *path) {
+	struct ptychite_recorder *recorder = calloc(1, sizeof(struct ptychite_recorder));
+	if (!recorder) {
+		return NULL;
+	}
+
+	if (!(recorder->file = fopen(path, "wb"))) {
+		wlr_log(WLR_ERROR, "Could not open '%s' for input recording", path);
+		free(recorder);
+		return NULL;
+	}
+	wl_list_init(&recorder->devices);
+	recorder->last_pointer = -1;
+
+	struct ptychite_record_header header = {.version = PTYCHITE_RECORD_VERSION};
+	memcpy(header.magic, PTYCHITE_RECORD_MAGIC, sizeof(header.magic));
+	if (fwrite(&header, sizeof(struct ptychite_record_header), 1, recorder->file) != 1) {
+		wlr_log(WLR_ERROR, "Could not write input recording header");
+		fclose(recorder->file);
+		free(recorder);
+		return NULL;
+	}
+
+	return recorder;
+}
+
+void ptychite_recorder_destroy(struct ptychite_recorder *recorder) {
+	struct recorder_device *r_device, *r_device_tmp;
+	wl_list_for_each_safe(r_device, r_device_tmp, &recorder->devices, link) {
+		recorder_device_destroy(r_device);
+	}
+
+	if (recorder->file) {
+		fclose(recorder->file);
+	}
+	free(recorder);
+}
+
+void ptychite_recorder_add_device(struct ptychite_recorder *recorder, struct wlr_input_device *device) {
+	if (device->type != WLR_INPUT_DEVICE_KEYBOARD && device->type != WLR_INPUT_DEVICE_POINTER) {
+		return;
+	}
+
+	if (recorder->next_device > UINT8_MAX) {
+		wlr_log(WLR_ERROR, "Too many input devices to record, ignoring '%s'", device->name);
+		return;
+	}
+
+	struct recorder_device *r_device = calloc(1, sizeof(struct recorder_device));
+	if (!r_device) {
+		return;
+	}
+
+	r_device->recorder = recorder;
+	r_device->device = device;
+	r_device->id = recorder->next_device++;
+	r_device->destroy.notify = recorder_device_handle_destroy;
+	wl_signal_add(&device->events.destroy, &r_device->destroy);
+	wl_list_insert(&recorder->devices, &r_device->link);
+
+	/* the name goes with the device, so per-device configuration applies on replay as it did when recording */
+	const char *name = device->name ? device->name : "";
+	size_t name_len = strnlen(name, UINT8_MAX);
+	char padded[UINT8_MAX + sizeof(struct ptychite_record_event)] = {0};
+	memcpy(padded, name, name_len);
+	size_t padded_len = (name_len + sizeof(struct ptychite_record_event) - 1) / sizeof(struct ptychite_record_event) *
+			sizeof(struct ptychite_record_event);
+
+	struct ptychite_record_event event = {
+			.type = PTYCHITE_RECORD_DEVICE_ADD,
+			.device = r_device->id,
+			.arg = device->type,
+			.time_msec = record_now_msec(),
+			.code = name_len,
+	};
+	recorder_write_bytes(recorder, &event, sizeof(struct ptychite_record_event));
+	if (padded_len) {
+		recorder_write_bytes(recorder, padded, padded_len);
+	}
+	if (recorder->file) {
+		fflush(recorder->file);
+	}
+}
+
+void ptychite_recorder_key(struct ptychite_recorder *recorder, struct wlr_keyboard *keyboard,
+		const struct wlr_keyboard_key_event *event) {
+	struct recorder_device *r_device = recorder_find_device(recorder, &keyboard->base);
+	if (!r_device) {
+		return;
+	}
+
+	recorder_write(recorder, &(struct ptychite_record_event){
+			.type = PTYCHITE_RECORD_KEY,
+			.device = r_device->id,
+			.arg = event->state,
+			.time_msec = event->time_msec,
+			.code = event->keycode,
+	});
+}
+
+void ptychite_recorder_motion(struct ptychite_recorder *recorder, const struct wlr_pointer_motion_event *event) {
+	struct recorder_device *r_device = recorder_find_device(recorder, &event->pointer->base);
+	if (!r_device) {
+		return;
+	}
+
+	recorder_write(recorder, &(struct ptychite_record_event){
+			.type = PTYCHITE_RECORD_MOTION,
+			.device = r_device->id,
+			.time_msec = event->time_msec,
+			.x = event->delta_x,
+			.y = event->delta_y,
+	});
+}
+
+void ptychite_recorder_motion_absolute(
+		struct ptychite_recorder *recorder, const struct wlr_pointer_motion_absolute_event *event) {
+	struct recorder_device *r_device = recorder_find_device(recorder, &event->pointer->base);
+	if (!r_device) {
+		return;
+	}
+
+	recorder_write(recorder, &(struct ptychite_record_event){
+			.type = PTYCHITE_RECORD_MOTION_ABSOLUTE,
+			.device = r_device->id,
+			.time_msec = event->time_msec,
+			.x = event->x,
+			.y = event->y,
+	});
+}
+
+void ptychite_recorder_button(struct ptychite_recorder *recorder, const struct wlr_pointer_button_event *event) {
+	struct recorder_device *r_device = recorder_find_device(recorder, &event->pointer->base);
+	if (!r_device) {
+		return;
+	}
+
+	recorder_write(recorder, &(struct ptychite_record_event){
+			.type = PTYCHITE_RECORD_BUTTON,
+			.device = r_device->id,
+			.arg = event->state,
+			.time_msec = event->time_msec,
+			.code = event->button,
+	});
+}
+
+void ptychite_recorder_axis(struct ptychite_recorder *recorder, const struct wlr_pointer_axis_event *event) {
+	struct recorder_device *r_device = recorder_find_device(recorder, &event->pointer->base);
+	if (!r_device) {
+		return;
+	}
+
+	recorder_write(recorder, &(struct ptychite_record_event){
+			.type = PTYCHITE_RECORD_AXIS,
+			.device = r_device->id,
+			.arg = (event->orientation & 0xff) | (event->source & 0xff) << 8,
+			.time_msec = event->time_msec,
+			.code = event->delta_discrete,
+			.x = event->delta,
+	});
+}
+
+void ptychite_recorder_frame(struct ptychite_recorder *recorder) {
+	if (recorder->last_pointer < 0) {
+		return;
+	}
+
+	recorder_write(recorder, &(struct ptychite_record_event){
+			.type = PTYCHITE_RECORD_FRAME,
+			.device = recorder->last_pointer,
+			.time_msec = record_now_msec(),
+	});
+}
+
+struct replay_device {
+	enum wlr_input_device_type type;
+	union {
+		struct wlr_keyboard keyboard;
+		struct wlr_pointer pointer;
+	};
+};
+
+struct ptychite_replay {
+	struct ptychite_server *server;
+	struct wl_array events;
+	size_t next;
+	bool started;
+	struct timespec start;
+	struct wl_event_source *timer;
+	struct replay_device *devices[UINT8_MAX + 1];
+	char *device_names[UINT8_MAX + 1];
+};
+
+static const struct wlr_keyboard_impl replay_keyboard_impl = {
+		.name = "ptychite-replay-keyboard",
+};
+
+static const struct wlr_pointer_impl replay_pointer_impl = {
+		.name = "ptychite-replay-pointer",
+};
+
+static void replay_device_destroy(struct replay_device *device) {
+	if (device->type == WLR_INPUT_DEVICE_KEYBOARD) {
+		wlr_keyboard_finish(&device->keyboard);
+	} else {
+		wlr_pointer_finish(&device->pointer);
+	}
+	free(device);
+}
+
+static void replay_add_device(struct ptychite_replay *replay, const struct ptychite_record_event *event) {
+	if (replay->devices[event->device]) {
+		replay_device_destroy(replay->devices[event->device]);
+		replay->devices[event->device] = NULL;
+	}
+
+	struct replay_device *device = calloc(1, sizeof(struct replay_device));
+	if (!device) {
+		return;
+	}
+
+	struct wlr_input_device *base;
+	const char *name = replay->device_names[event->device];
+	device->type = event->arg;
+	switch (device->type) {
+	case WLR_INPUT_DEVICE_KEYBOARD:
+		wlr_keyboard_init(&device->keyboard, &replay_keyboard_impl, name ? name : replay_keyboard_impl.name);
+		base = &device->keyboard.base;
+		break;
+	case WLR_INPUT_DEVICE_POINTER:
+		wlr_pointer_init(&device->pointer, &replay_pointer_impl, name ? name : replay_pointer_impl.name);
+		base = &device->pointer.base;
+		break;
+	default:
+		free(device);
+		return;
+	}
+
+	replay->devices[event->device] = device;
+	/* virtual devices enter through the same path as the backend's own, so the server sets them up as usual */
+	wl_signal_emit_mutable(&replay->server->backend->events.new_input, base);
+}
+
+static struct wlr_pointer *replay_get_pointer(struct ptychite_replay *replay, uint8_t id) {
+	struct replay_device *device = replay->devices[id];
+	if (!device || device->type != WLR_INPUT_DEVICE_POINTER) {
+		return NULL;
+	}
+
+	return &device->pointer;
+}
+
+static void replay_dispatch(struct ptychite_replay *replay, const struct ptychite_record_event *event) {
+	struct wlr_pointer *pointer;
+
+	switch (event->type) {
+	case PTYCHITE_RECORD_DEVICE_ADD:
+		replay_add_device(replay, event);
+		break;
+	case PTYCHITE_RECORD_DEVICE_REMOVE:
+		if (replay->devices[event->device]) {
+			replay_device_destroy(replay->devices[event->device]);
+			replay->devices[event->device] = NULL;
+		}
+		break;
+	case PTYCHITE_RECORD_KEY: {
+		struct replay_device *device = replay->devices[event->device];
+		if (!device || device->type != WLR_INPUT_DEVICE_KEYBOARD) {
+			break;
+		}
+		struct wlr_keyboard_key_event key_event = {
+				.time_msec = event->time_msec,
+				.keycode = event->code,
+				.update_state = true,
+				.state = event->arg,
+		};
+		wlr_keyboard_notify_key(&device->keyboard, &key_event);
+		break;
+	}
+	case PTYCHITE_RECORD_MOTION:
+		if ((pointer = replay_get_pointer(replay, event->device))) {
+			struct wlr_pointer_motion_event motion_event = {
+					.pointer = pointer,
+					.time_msec = event->time_msec,
+					.delta_x = event->x,
+					.delta_y = event->y,
+					.unaccel_dx = event->x,
+					.unaccel_dy = event->y,
+			};
+			wl_signal_emit_mutable(&pointer->events.motion, &motion_event);
+		}
+		break;
+	case PTYCHITE_RECORD_MOTION_ABSOLUTE:
+		if ((pointer = replay_get_pointer(replay, event->device))) {
+			struct wlr_pointer_motion_absolute_event motion_event = {
+					.pointer = pointer,
+					.time_msec = event->time_msec,
+					.x = event->x,
+					.y = event->y,
+			};
+			wl_signal_emit_mutable(&pointer->events.motion_absolute, &motion_event);
+		}
+		break;
+	case PTYCHITE_RECORD_BUTTON:
+		if ((pointer = replay_get_pointer(replay, event->device))) {
+			struct wlr_pointer_button_event button_event = {
+					.pointer = pointer,
+					.time_msec = event->time_msec,
+					.button = event->code,
+					.state = event->arg,
+			};
+			wl_signal_emit_mutable(&pointer->events.button, &button_event);
+		}
+		break;
+	case PTYCHITE_RECORD_AXIS:
+		if ((pointer = replay_get_pointer(replay, event->device))) {
+			struct wlr_pointer_axis_event axis_event = {
+					.pointer = pointer,
+					.time_msec = event->time_msec,
+					.source = event->arg >> 8,
+					.orientation = event->arg & 0xff,
+					.delta = event->x,
+					.delta_discrete = event->code,
+			};
+			wl_signal_emit_mutable(&pointer->events.axis, &axis_event);
+		}
+		break;
+	case PTYCHITE_RECORD_FRAME:
+		if ((pointer = replay_get_pointer(replay, event->device))) {
+			wl_signal_emit_mutable(&pointer->events.frame, pointer);
+		}
+		break;
+	default:
+		wlr_log(WLR_ERROR, "Unknown event type %d in input recording", event->type);
+		break;
+	}
+}
+
+static int replay_handle_timer(void *data) {
+	struct ptychite_replay *replay = data;
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (!replay->started) {
+		replay->start = now;
+		replay->started = true;
+	}
+	double elapsed_ms = ptychite_timespec_diff_ms(&replay->start, &now);
+
+	/* events keep the offsets they were recorded with, relative to the first one */
+	const struct ptychite_record_event *events = replay->events.data;
+	size_t len = replay->events.size / sizeof(struct ptychite_record_event);
+	uint32_t base_msec = events[0].time_msec;
+	while (replay->next < len) {
+		const struct ptychite_record_event *event = &events[replay->next];
+		uint32_t offset_msec = event->time_msec - base_msec;
+		if (offset_msec > elapsed_ms) {
+			wl_event_source_timer_update(replay->timer, offset_msec - (uint32_t)elapsed_ms);
+			return 0;
+		}
+
+		replay->next++;
+		replay_dispatch(replay, event);
+	}
+
+	wlr_log(WLR_INFO, "Finished replaying %zu input events in %.3f ms", len, elapsed_ms);
+	return 0;
+}
+
+struct ptychite_replay *ptychite_replay_create(struct ptychite_server *server, const char *path) {
+	struct ptychite_replay *replay = calloc(1, sizeof(struct ptychite_replay));
+	if (!replay) {
+		return NULL;
+	}
+	replay->server = server;
+	wl_array_init(&replay->events);
+
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		wlr_log(WLR_ERROR, "Could not open input recording '%s'", path);
+		goto err;
+	}
+
+	struct ptychite_record_header header;
+	if (fread(&header, sizeof(struct ptychite_record_header), 1, file) != 1 ||
+			memcmp(header.magic, PTYCHITE_RECORD_MAGIC, sizeof(header.magic)) ||
+			header.version != PTYCHITE_RECORD_VERSION) {
+		wlr_log(WLR_ERROR, "'%s' is not a compatible input recording", path);
+		goto err_file;
+	}
+
+	struct ptychite_record_event event;
+	while (fread(&event, sizeof(struct ptychite_record_event), 1, file) == 1) {
+		struct ptychite_record_event *slot = wl_array_add(&replay->events, sizeof(struct ptychite_record_event));
+		if (!slot) {
+			goto err_file;
+		}
+		*slot = event;
+
+		if (event.type != PTYCHITE_RECORD_DEVICE_ADD || !event.code) {
+			continue;
+		}
+
+		if (event.code < 0 || event.code > UINT8_MAX) {
+			wlr_log(WLR_ERROR, "'%s' is not a compatible input recording", path);
+			goto err_file;
+		}
+
+		char padded[UINT8_MAX + sizeof(struct ptychite_record_event)];
+		size_t name_len = event.code;
+		size_t padded_len = (name_len + sizeof(struct ptychite_record_event) - 1) /
+				sizeof(struct ptychite_record_event) * sizeof(struct ptychite_record_event);
+		if (fread(padded, padded_len, 1, file) != 1) {
+			wlr_log(WLR_ERROR, "Input recording '%s' is truncated", path);
+			goto err_file;
+		}
+
+		free(replay->device_names[event.device]);
+		replay->device_names[event.device] = strndup(padded, name_len);
+	}
+	fclose(file);
+
+	if (!replay->events.size) {
+		wlr_log(WLR_ERROR, "Input recording '%s' is empty", path);
+		goto err;
+	}
+
+	if (!(replay->timer =
+					wl_event_loop_add_timer(wl_display_get_event_loop(server->display), replay_handle_timer, replay))) {
+		goto err;
+	}
+	wl_event_source_timer_update(replay->timer, 1);
+
+	return replay;
+
+err_file:
+	fclose(file);
+err:
+	for (size_t i = 0; i < UINT8_MAX + 1; i++) {
+		free(replay->device_names[i]);
+	}
+	wl_array_release(&replay->events);
+	free(replay);
+	return NULL;
+}
+
+void ptychite_replay_destroy(struct ptychite_replay *replay) {
+	wl_event_source_remove(replay->timer);
+
+	for (size_t i = 0; i < UINT8_MAX + 1; i++) {
+		if (replay->devices[i]) {
+			replay_device_destroy(replay->devices[i]);
+		}
+		free(replay->device_names[i]);
+	}
+
+	wl_array_release(&replay->events);
+	free(replay);
+}
@@ -0,0 +1,64 @@
+#ifndef PTYCHITE_RECORD_H
+#define PTYCHITE_RECORD_H
+
+#include <stdint.h>
+
+#include <wlr/types/wlr_keyboard.h>
+#include <wlr/types/wlr_pointer.h>
+
+struct ptychite_server;
+
+#define PTYCHITE_RECORD_MAGIC "PTYREC"
+#define PTYCHITE_RECORD_VERSION 2
+
+enum ptychite_record_event_type {
+	PTYCHITE_RECORD_DEVICE_ADD,
+	PTYCHITE_RECORD_DEVICE_REMOVE,
+	PTYCHITE_RECORD_KEY,
+	PTYCHITE_RECORD_MOTION,
+	PTYCHITE_RECORD_MOTION_ABSOLUTE,
+	PTYCHITE_RECORD_BUTTON,
+	PTYCHITE_RECORD_AXIS,
+	PTYCHITE_RECORD_FRAME,
+};
+
+/* recordings are a header followed by fixed size events in host byte order, times are the CLOCK_MONOTONIC
+ * milliseconds the backend stamped the events with. a device add is followed by the device name, code bytes long
+ * and zero padded to a whole number of events */
+struct ptychite_record_header {
+	char magic[6];
+	uint16_t version;
+};
+
+struct ptychite_record_event {
+	uint8_t type;
+	uint8_t device;
+	/* device type, key or button state, or axis orientation in the low and source in the high byte */
+	uint16_t arg;
+	uint32_t time_msec;
+	/* keycode, button, discrete axis delta, or device name length */
+	int32_t code;
+	uint32_t padding;
+	/* motion delta, absolute position or axis delta in x */
+	double x, y;
+};
+
+struct ptychite_recorder;
+struct ptychite_replay;
+
+struct ptychite_recorder *ptychite_recorder_create(const char *path);
+void ptychite_recorder_destroy(struct ptychite_recorder *recorder);
+void ptychite_recorder_add_device(struct ptychite_recorder *recorder, struct wlr_input_device *device);
+void ptychite_recorder_key(struct ptychite_recorder *recorder, struct wlr_keyboard *keyboard,
+		const struct wlr_keyboard_key_event *event);
+void ptychite_recorder_motion(struct ptychite_recorder *recorder, const struct wlr_pointer_motion_event *event);
+void ptychite_recorder_motion_absolute(
+		struct ptychite_recorder *recorder, const struct wlr_pointer_motion_absolute_event *event);
+void ptychite_recorder_button(struct ptychite_recorder *recorder, const struct wlr_pointer_button_event *event);
+void ptychite_recorder_axis(struct ptychite_recorder *recorder, const struct wlr_pointer_axis_event *event);
+void ptychite_recorder_frame(struct ptychite_recorder *recorder);
+
+struct ptychite_replay *ptychite_replay_create(struct ptychite_server *server, const char *path);
+void ptychite_replay_destroy(struct ptychite_replay *replay);
+
+#endif
@@ -3,8 +3,11 @@
 #include <cairo.h>
 #include <drm_fourcc.h>
 #include <linux/input-event-codes.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 #include <wayland-server-core.h>
@@ -28,6 +31,7 @@
 #include <wlr/types/wlr_idle_notify_v1.h>
 #include <wlr/types/wlr_matrix.h>
 #include <wlr/types/wlr_output_management_v1.h>
+#include <wlr/types/wlr_output_power_management_v1.h>
 #include <wlr/types/wlr_presentation_time.h>
 #include <wlr/types/wlr_screencopy_v1.h>
 #include <wlr/types/wlr_server_decoration.h>
@@ -35,6 +39,7 @@
 #include <wlr/types/wlr_subcompositor.h>
 #include <wlr/types/wlr_viewporter.h>
 #include <wlr/types/wlr_xcursor_manager.h>
+#include <wlr/types/wlr_xdg_activation_v1.h>
 #include <wlr/types/wlr_xdg_decoration_v1.h>
 #include <wlr/types/wlr_xdg_output_v1.h>
 #include <wlr/types/wlr_xdg_shell.h>
@@ -48,18 +53,240 @@
 #include "macros.h"
 #include "message.h"
 #include "monitor.h"
+#include "record.h"
 #include "server.h"
 #include "util.h"
 #include "view.h"
 #include "windows.h"
 
+extern char **environ;
+
+struct server_child {
+	struct wl_list link;
+	struct ptychite_server *server;
+	pid_t pid;
+	int pidfd;
+	struct wl_event_source *source;
+};
+
+static void server_child_destroy(struct server_child *child) {
+	if (child->source) {
+		wl_event_source_remove(child->source);
+	}
+	if (child->pidfd >= 0) {
+		close(child->pidfd);
+	}
+	wl_list_remove(&child->link);
+	free(child);
+}
+
+static int server_handle_child_exit(int fd, uint32_t mask, void *data) {
+	struct server_child *child = data;
+
+	if (waitpid(child->pid, NULL, WNOHANG) == 0 && !(mask & (WL_EVENT_HANGUP | WL_EVENT_ERROR))) {
+		return 0;
+	}
+
+	wlr_log(WLR_DEBUG, "Child %d exited", child->pid);
+	server_child_destroy(child);
+
+	return 0;
+}
+
+static void server_reap_untracked_children(struct ptychite_server *server) {
+	struct server_child *child, *child_tmp;
+	wl_list_for_each_safe(child, child_tmp, &server->children, link) {
+		if (child->source) {
+			continue;
+		}
+		if (waitpid(child->pid, NULL, WNOHANG) != 0) {
+			server_child_destroy(child);
+		}
+	}
+}
+
+static int server_handle_sigchld(int signal_number, void *data) {
+	struct ptychite_server *server = data;
+
+	server_reap_untracked_children(server);
+
+	return 0;
+}
+
+struct server_launch {
+	struct wl_list link;
+	struct ptychite_server *server;
+	struct wlr_xdg_activation_token_v1 *token;
+	pid_t pid;
+	struct timespec start;
+	bool recorded;
+
+	struct wl_listener token_destroy;
+};
+
+static void server_record_launch(
+		struct ptychite_server *server, const char *app_id, const struct timespec *start, const struct timespec *end) {
+	double ms = ptychite_timespec_diff_ms(start, end);
+	if (!app_id) {
+		app_id = "";
+	}
+
+	struct ptychite_launch_stats *stats, *found = NULL;
+	wl_list_for_each(stats, &server->launch_stats, link) {
+		if (!strcmp(stats->app_id, app_id)) {
+			found = stats;
+			break;
+		}
+	}
+	if (!found) {
+		if (!(found = calloc(1, sizeof(struct ptychite_launch_stats)))) {
+			return;
+		}
+		if (!(found->app_id = strdup(app_id))) {
+			free(found);
+			return;
+		}
+		wl_list_insert(server->launch_stats.prev, &found->link);
+	}
+
+	int bucket = 0;
+	while (bucket < PTYCHITE_LAUNCH_HISTOGRAM_BUCKETS - 1 && ms >= (32 << bucket)) {
+		bucket++;
+	}
+	found->buckets[bucket]++;
+	found->count++;
+	found->total_ms += ms;
+	if (ms > found->max_ms) {
+		found->max_ms = ms;
+	}
+
+	wlr_log(WLR_DEBUG, "Launch of '%s' mapped after %.3f ms", app_id, ms);
+}
+
+static void server_launch_destroy(struct server_launch *launch) {
+	wl_list_remove(&launch->token_destroy.link);
+	wl_list_remove(&launch->link);
+	free(launch);
+}
+
+static void server_launch_handle_token_destroy(struct wl_listener *listener, void *data) {
+	struct server_launch *launch = wl_container_of(listener, launch, token_destroy);
+
+	server_launch_destroy(launch);
+}
+
+static struct server_launch *server_launch_create(struct ptychite_server *server) {
+	if (!server->xdg_activation) {
+		return NULL;
+	}
+
+	struct server_launch *launch = calloc(1, sizeof(struct server_launch));
+	if (!launch) {
+		return NULL;
+	}
+
+	if (!(launch->token = wlr_xdg_activation_token_v1_create(server->xdg_activation))) {
+		free(launch);
+		return NULL;
+	}
+	launch->token->data = launch;
+	launch->server = server;
+	clock_gettime(CLOCK_MONOTONIC, &launch->start);
+
+	launch->token_destroy.notify = server_launch_handle_token_destroy;
+	wl_signal_add(&launch->token->events.destroy, &launch->token_destroy);
+	wl_list_insert(&server->launches, &launch->link);
+
+	return launch;
+}
+
+static struct ptychite_view *server_view_from_surface(struct wlr_surface *surface) {
+	struct wlr_xdg_surface *xdg_surface = wlr_xdg_surface_try_from_wlr_surface(surface);
+	if (!xdg_surface || xdg_surface->role != WLR_XDG_SURFACE_ROLE_TOPLEVEL || !xdg_surface->data) {
+		return NULL;
+	}
+
+	struct wlr_scene_tree *scene_tree = xdg_surface->data;
+	struct ptychite_element *element = scene_tree->node.data;
+	if (!element) {
+		return NULL;
+	}
+
+	return ptychite_element_get_view(element);
+}
+
+static void server_handle_xdg_activation_request(struct wl_listener *listener, void *data) {
+	struct ptychite_server *server = wl_container_of(listener, server, xdg_activation_request);
+	const struct wlr_xdg_activation_v1_request_activate_event *event = data;
+
+	struct ptychite_view *view = server_view_from_surface(event->surface);
+	if (!view) {
+		return;
+	}
+
+	struct server_launch *launch = event->token->data;
+	if (launch) {
+		if (!launch->recorded) {
+			launch->recorded = true;
+			if (view->xdg_toplevel->base->surface->mapped) {
+				server_record_launch(server, view->xdg_toplevel->app_id, &launch->start, &view->map_time);
+			} else {
+				view->launch_start = launch->start;
+				view->launch_pending = true;
+			}
+		}
+	} else if (!event->token->seat) {
+		/* tokens not backed by our own launches or by user input would steal focus */
+		return;
+	}
+
+	if (view->xdg_toplevel->base->surface->mapped && view->monitor) {
+		ptychite_view_focus(view, view->xdg_toplevel->base->surface);
+	}
+}
+
+void ptychite_server_match_launch(struct ptychite_server *server, struct ptychite_view *view) {
+	clock_gettime(CLOCK_MONOTONIC, &view->map_time);
+
+	if (view->launch_pending) {
+		view->launch_pending = false;
+		server_record_launch(server, view->xdg_toplevel->app_id, &view->launch_start, &view->map_time);
+		return;
+	}
+
+	/* clients that ignore XDG_ACTIVATION_TOKEN are matched on the pid of the spawned process */
+	pid_t pid;
+	wl_client_get_credentials(view->xdg_toplevel->base->client->client, &pid, NULL, NULL);
+
+	struct server_launch *launch;
+	wl_list_for_each(launch, &server->launches, link) {
+		if (launch->recorded || launch->pid != pid) {
+			continue;
+		}
+		launch->recorded = true;
+		server_record_launch(server, view->xdg_toplevel->app_id, &launch->start, &view->map_time);
+		break;
+	}
+}
+
 static void server_activate_monitor(struct ptychite_server *server, struct ptychite_monitor *monitor) {
 	server->active_monitor = monitor;
 }
 
 struct ptychite_element *server_identify_element_at(struct ptychite_server *server, double lx, double ly, double *sx,
 		double *sy, struct wlr_scene_buffer **scene_buffer) {
-	struct wlr_scene_node *scene_node = wlr_scene_node_at(&server->scene->tree.node, lx, ly, sx, sy);
+	struct wlr_scene_node *scene_node;
+	struct wlr_output *output = wlr_output_layout_output_at(server->output_layout, lx, ly);
+	struct ptychite_monitor *monitor = output ? output->data : NULL;
+	if (monitor && monitor->hit_grid.dirty &&
+			!ptychite_hit_grid_rebuild(&monitor->hit_grid, &server->scene->tree, &monitor->geometry)) {
+		monitor = NULL;
+	}
+	if (monitor) {
+		scene_node = ptychite_hit_grid_node_at(&monitor->hit_grid, lx, ly, sx, sy);
+	} else {
+		scene_node = wlr_scene_node_at(&server->scene->tree.node, lx, ly, sx, sy);
+	}
 
 	if (!scene_node || scene_node->type != WLR_SCENE_NODE_BUFFER) {
 		return NULL;
@@ -80,8 +307,14 @@ struct ptychite_element *server_identify_element_at(struct ptychite_server *serv
 static void server_process_cursor_move(struct ptychite_server *server, uint32_t time) {
 	struct ptychite_view *view = server->grabbed_view;
 
-	wlr_scene_node_set_position(
-			&view->element.scene_tree->node, server->cursor->x - server->grab_x, server->cursor->y - server->grab_y);
+	int parent_x, parent_y;
+	wlr_scene_node_coords(&view->element.scene_tree->node.parent->node, &parent_x, &parent_y);
+	wlr_scene_node_set_position(&view->element.scene_tree->node, server->cursor->x - server->grab_x - parent_x,
+			server->cursor->y - server->grab_y - parent_y);
+	ptychite_server_invalidate_hit_grids(server);
+	if (view->monitor) {
+		ptychite_monitor_note_input_response(view->monitor);
+	}
 }
 
 static void server_process_cursor_resize(struct ptychite_server *server, uint32_t time) {
@@ -90,21 +323,19 @@ static void server_process_cursor_resize(struct ptychite_server *server, uint32_
 	double border_x = server->cursor->x - server->grab_x;
 	double border_y = server->cursor->y - server->grab_y;
 
-	int new_left = view->element.scene_tree->node.x;
-	int new_right = view->element.scene_tree->node.x + view->element.width;
-	int new_top = view->element.scene_tree->node.y;
-	int new_bottom = view->element.scene_tree->node.y + view->element.height;
+	int new_left, new_top;
+	wlr_scene_node_coords(&view->element.scene_tree->node, &new_left, &new_top);
 
-	new_right = border_x;
+	int new_right = border_x;
 	if (new_right <= new_left) {
 		new_right = new_left + 1;
 	}
-	new_bottom = border_y;
+	int new_bottom = border_y;
 	if (new_bottom <= new_top) {
 		new_bottom = new_top + 1;
 	}
 
-	ptychite_view_resize(view, new_right - new_left, new_bottom - new_top);
+	ptychite_view_interactive_resize(view, new_right - new_left, new_bottom - new_top);
 }
 
 static void server_process_cursor_motion(struct ptychite_server *server, uint32_t time) {
@@ -153,12 +384,12 @@ static void server_process_cursor_motion(struct ptychite_server *server, uint32_
 			}
 			ptychite_window_relay_pointer_move(window, sx, sy);
 			wlr_seat_pointer_clear_focus(server->seat);
-			wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "left_ptr");
+			ptychite_server_set_cursor_image(server, "left_ptr");
 			break;
 		}
 		}
 	} else {
-		wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "left_ptr");
+		ptychite_server_set_cursor_image(server, "left_ptr");
 		wlr_seat_pointer_clear_focus(server->seat);
 		if (server->hovered_window) {
 			ptychite_window_relay_pointer_leave(server->hovered_window);
@@ -167,10 +398,137 @@ static void server_process_cursor_motion(struct ptychite_server *server, uint32_
 	}
 }
 
+static void server_stamp_pointer_input(struct ptychite_server *server) {
+	struct wlr_output *output =
+			wlr_output_layout_output_at(server->output_layout, server->cursor->x, server->cursor->y);
+	if (output && output->data) {
+		ptychite_monitor_stamp_input(output->data);
+	}
+}
+
+/* motion over compositor drawn windows only changes their hover state, which is not visible before the next frame
+ * anyway, so it is collapsed into one hit test per frame instead of one per event */
+static void server_queue_cursor_motion(struct ptychite_server *server, uint32_t time) {
+	struct ptychite_monitor *monitor = server->active_monitor;
+	if (!server->hovered_window || server->cursor_mode != PTYCHITE_CURSOR_PASSTHROUGH || !monitor ||
+			!monitor->output->enabled) {
+		server->pending_window_motion = false;
+		server_process_cursor_motion(server, time);
+		return;
+	}
+
+	server->pending_window_motion_time = time;
+	if (!server->pending_window_motion) {
+		server->pending_window_motion = true;
+		wlr_output_schedule_frame(monitor->output);
+	}
+}
+
+void ptychite_server_flush_cursor_motion(struct ptychite_server *server) {
+	if (!server->pending_window_motion) {
+		return;
+	}
+
+	server->pending_window_motion = false;
+	server_process_cursor_motion(server, server->pending_window_motion_time);
+}
+
 static void server_new_pointer(struct ptychite_server *server, struct wlr_input_device *device) {
 	wlr_cursor_attach_input_device(server->cursor, device);
 }
 
+struct server_keymap {
+	struct wl_list link;
+	char *rules, *model, *layout, *variant, *options;
+	struct xkb_keymap *keymap;
+};
+
+static bool server_keymap_name_equal(const char *name1, const char *name2) {
+	return !strcmp(name1 ? name1 : "", name2 ? name2 : "");
+}
+
+static void server_keymap_destroy(struct server_keymap *keymap) {
+	wl_list_remove(&keymap->link);
+	xkb_keymap_unref(keymap->keymap);
+	free(keymap->rules);
+	free(keymap->model);
+	free(keymap->layout);
+	free(keymap->variant);
+	free(keymap->options);
+	free(keymap);
+}
+
+/* compiling a keymap takes tens of milliseconds, so every distinct set of rule names is compiled once and shared by
+ * all keyboards that use it */
+static struct xkb_keymap *server_get_keymap(struct ptychite_server *server, const struct xkb_rule_names *names) {
+	struct server_keymap *keymap;
+	wl_list_for_each(keymap, &server->keymaps, link) {
+		if (server_keymap_name_equal(keymap->rules, names->rules) &&
+				server_keymap_name_equal(keymap->model, names->model) &&
+				server_keymap_name_equal(keymap->layout, names->layout) &&
+				server_keymap_name_equal(keymap->variant, names->variant) &&
+				server_keymap_name_equal(keymap->options, names->options)) {
+			return keymap->keymap;
+		}
+	}
+
+	if (!(keymap = calloc(1, sizeof(struct server_keymap)))) {
+		return NULL;
+	}
+	wl_list_insert(&server->keymaps, &keymap->link);
+
+	if ((names->rules && *names->rules && !(keymap->rules = strdup(names->rules))) ||
+			(names->model && *names->model && !(keymap->model = strdup(names->model))) ||
+			(names->layout && *names->layout && !(keymap->layout = strdup(names->layout))) ||
+			(names->variant && *names->variant && !(keymap->variant = strdup(names->variant))) ||
+			(names->options && *names->options && !(keymap->options = strdup(names->options)))) {
+		server_keymap_destroy(keymap);
+		return NULL;
+	}
+
+	if (!(keymap->keymap = xkb_keymap_new_from_names(server->xkb_context, names, XKB_KEYMAP_COMPILE_NO_FLAGS))) {
+		wlr_log(WLR_ERROR, "Could not compile keymap with layout '%s' and variant '%s'",
+				names->layout ? names->layout : "", names->variant ? names->variant : "");
+		server_keymap_destroy(keymap);
+		return NULL;
+	}
+
+	return keymap->keymap;
+}
+
+static void server_configure_keyboard(struct ptychite_server *server, struct ptychite_keyboard *keyboard) {
+	struct ptychite_config *config = server->compositor->config;
+
+	wlr_keyboard_set_repeat_info(keyboard->keyboard, config->keyboard.repeat.rate, config->keyboard.repeat.delay);
+
+	struct xkb_rule_names rule_names = {
+			.options = config->keyboard.xkb.options,
+			.rules = NULL,
+			.layout = config->keyboard.xkb.layout,
+			.model = NULL,
+			.variant = config->keyboard.xkb.variant,
+	};
+
+	struct ptychite_keyboard_device *device;
+	wl_array_for_each(device, &config->keyboard.xkb.devices) {
+		if (keyboard->keyboard->base.name && !strcmp(device->name, keyboard->keyboard->base.name)) {
+			rule_names.layout = device->layout;
+			rule_names.variant = device->variant;
+			break;
+		}
+	}
+
+	struct xkb_keymap *keymap = server_get_keymap(server, &rule_names);
+	if (!keymap && !keyboard->keyboard->keymap) {
+		keymap = server_get_keymap(server, &(struct xkb_rule_names){0});
+	}
+
+	/* setting the same keymap again would only reset the active layout */
+	if (keymap && keymap != keyboard->keyboard->keymap) {
+		wlr_keyboard_set_keymap(keyboard->keyboard, keymap);
+	}
+}
+
 static void server_new_keyboard(struct ptychite_server *server, struct wlr_input_device *device) {
 	struct ptychite_keyboard *p_keyboard = calloc(1, sizeof(struct ptychite_keyboard));
 	if (!p_keyboard) {
@@ -183,25 +541,7 @@ static void server_new_keyboard(struct ptychite_server *server, struct wlr_input
 	p_keyboard->server = server;
 	p_keyboard->keyboard = keyboard;
 
-	wlr_keyboard_set_repeat_info(keyboard, server->compositor->config->keyboard.repeat.rate,
-			server->compositor->config->keyboard.repeat.delay);
-
-	struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-	if (context) {
-		struct xkb_rule_names rules = (struct xkb_rule_names){
-				.options = server->compositor->config->keyboard.xkb.options,
-				.rules = NULL,
-				.layout = NULL,
-				.model = NULL,
-				.variant = NULL,
-		};
-		struct xkb_keymap *keymap = xkb_keymap_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
-		wlr_keyboard_set_keymap(keyboard, keymap);
-		xkb_keymap_unref(keymap);
-		xkb_context_unref(context);
-	} else {
-		wlr_keyboard_set_keymap(keyboard, NULL);
-	}
+	server_configure_keyboard(server, p_keyboard);
 
 	ptychite_keyboard_rig(p_keyboard, device);
 
@@ -273,35 +613,56 @@ static int server_time_tick_update(void *data) {
 		}
 	}
 
+	if (server->hud.base.element.scene_tree->node.enabled) {
+		ptychite_hud_draw_auto(&server->hud);
+	}
+
 	server->seconds++;
-	wl_event_source_timer_update(server->time_tick, 1000);
+	if (!server->outputs_off) {
+		wl_event_source_timer_update(server->time_tick, 1000);
+	}
 
 	return 0;
 }
 
+/* removing an output from the layout also destroys its scene output, so one is created whenever it is missing */
+static void server_add_output_to_layout(
+		struct ptychite_server *server, struct wlr_output *output, bool position_set, int x, int y) {
+	struct wlr_output_layout_output *l_output = position_set
+			? wlr_output_layout_add(server->output_layout, output, x, y)
+			: wlr_output_layout_add_auto(server->output_layout, output);
+	if (!l_output || wlr_scene_get_scene_output(server->scene, output)) {
+		return;
+	}
+
+	struct wlr_scene_output *scene_output = wlr_scene_output_create(server->scene, output);
+	if (!scene_output) {
+		wlr_log(WLR_ERROR, "Could not initialize scene output: insufficent memory");
+		return;
+	}
+	wlr_scene_output_layout_add_output(server->scene_layout, l_output, scene_output);
+}
+
 static void server_update_monitors(struct ptychite_server *server) {
-	struct wlr_output_configuration_v1 *output_config = wlr_output_configuration_v1_create();
+	bool changed = false;
 
 	struct ptychite_monitor *monitor;
 	wl_list_for_each(monitor, &server->monitors, link) {
-		if (monitor->output->enabled) {
+		if (monitor->output->enabled || monitor->power.off) {
 			continue;
 		}
 
-		if (output_config) {
-			struct wlr_output_configuration_head_v1 *head =
-					wlr_output_configuration_head_v1_create(output_config, monitor->output);
-			if (head) {
-				head->state.enabled = false;
-			}
+		if (monitor->applied.enabled || wlr_output_layout_get(server->output_layout, monitor->output)) {
+			wlr_output_layout_remove(server->output_layout, monitor->output);
+			ptychite_monitor_disable(monitor);
+			monitor->applied.enabled = false;
+			changed = true;
 		}
-		wlr_output_layout_remove(server->output_layout, monitor->output);
-		ptychite_monitor_disable(monitor);
 	}
 
 	wl_list_for_each(monitor, &server->monitors, link) {
 		if (monitor->output->enabled && !wlr_output_layout_get(server->output_layout, monitor->output)) {
-			wlr_output_layout_add_auto(server->output_layout, monitor->output);
+			server_add_output_to_layout(server, monitor->output, false, 0, 0);
 		}
 	}
 
@@ -310,7 +671,25 @@ static void server_update_monitors(struct ptychite_server *server) {
 			continue;
 		}
 
-		wlr_output_layout_get_box(server->output_layout, monitor->output, &monitor->geometry);
+		struct wlr_box geometry;
+		wlr_output_layout_get_box(server->output_layout, monitor->output, &geometry);
+		if (monitor->output->refresh != monitor->applied.refresh ||
+				monitor->output->transform != monitor->applied.transform) {
+			monitor->applied.refresh = monitor->output->refresh;
+			monitor->applied.transform = monitor->output->transform;
+			changed = true;
+		}
+
+		/* only monitors that moved, resized or rescaled have anything to repaint or retile */
+		if (monitor->applied.enabled && wlr_box_equal(&geometry, &monitor->geometry) &&
+				monitor->output->scale == monitor->applied.scale) {
+			continue;
+		}
+		monitor->applied.enabled = true;
+		monitor->applied.scale = monitor->output->scale;
+		changed = true;
+
+		monitor->geometry = geometry;
 		if (monitor->panel && monitor->panel->base.element.scene_tree->node.enabled) {
 			monitor->window_geometry = (struct wlr_box){
 					.x = monitor->geometry.x,
@@ -337,90 +716,453 @@ static void server_update_monitors(struct ptychite_server *server) {
 		}
 
 		ptychite_monitor_tile(monitor);
+	}
 
-		if (output_config) {
-			struct wlr_output_configuration_head_v1 *head =
-					wlr_output_configuration_head_v1_create(output_config, monitor->output);
-			if (head) {
-				head->state.enabled = true;
-				head->state.mode = monitor->output->current_mode;
-				head->state.x = monitor->geometry.x;
-				head->state.y = monitor->geometry.y;
-			}
-		}
+	if (!changed) {
+		return;
 	}
 
+	ptychite_server_invalidate_hit_grids(server);
 	if (server->control->base.element.scene_tree->node.enabled) {
 		ptychite_control_draw_auto(server->control);
 	}
 
+	struct wlr_output_configuration_v1 *output_config = wlr_output_configuration_v1_create();
+	if (!output_config) {
+		return;
+	}
+
+	wl_list_for_each(monitor, &server->monitors, link) {
+		struct wlr_output_configuration_head_v1 *head =
+				wlr_output_configuration_head_v1_create(output_config, monitor->output);
+		if (!head) {
+			continue;
+		}
+
+		head->state.enabled = monitor->output->enabled || monitor->power.off;
+		if (head->state.enabled) {
+			head->state.mode = monitor->output->current_mode;
+			head->state.x = monitor->geometry.x;
+			head->state.y = monitor->geometry.y;
+		}
+	}
+
 	wlr_output_manager_v1_set_configuration(server->output_mgr, output_config);
 }
 
+static void server_handle_update_monitors_idle(void *data) {
+	struct ptychite_server *server = data;
+
+	server->update_monitors_idle = NULL;
+	server_update_monitors(server);
+}
+
+static bool server_output_head_changed(struct wlr_output_configuration_head_v1 *head) {
+	struct wlr_output *output = head->state.output;
+
+	if (head->state.enabled != output->enabled) {
+		return true;
+	}
+	if (!head->state.enabled) {
+		return false;
+	}
+
+	if (head->state.mode) {
+		if (head->state.mode != output->current_mode) {
+			return true;
+		}
+	} else if (head->state.custom_mode.width != output->width || head->state.custom_mode.height != output->height ||
+			(head->state.custom_mode.refresh && head->state.custom_mode.refresh != output->refresh)) {
+		return true;
+	}
+
+	return head->state.transform != output->transform || head->state.scale != output->scale ||
+			head->state.adaptive_sync_enabled != (output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED);
+}
+
+struct server_output_commit {
+	struct wlr_output *output;
+	struct wlr_output_state state;
+};
+
+static void server_output_save_state(struct wlr_output *output, struct wlr_output_state *state) {
+	wlr_output_state_init(state);
+	wlr_output_state_set_enabled(state, output->enabled);
+	if (!output->enabled) {
+		return;
+	}
+
+	if (output->current_mode) {
+		wlr_output_state_set_mode(state, output->current_mode);
+	} else {
+		wlr_output_state_set_custom_mode(state, output->width, output->height, output->refresh);
+	}
+	wlr_output_state_set_scale(state, output->scale);
+	wlr_output_state_set_transform(state, output->transform);
+	wlr_output_state_set_adaptive_sync_enabled(state, output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED);
+}
+
+/* wlroots 0.17 can only commit one output at a time, so every state is tested before any is committed, and the
+ * outputs already committed are put back as they were if a later commit still fails */
+static bool server_commit_outputs(struct server_output_commit *commits, size_t commits_len, bool test) {
+	size_t i;
+	for (i = 0; i < commits_len; i++) {
+		if (!wlr_output_test_state(commits[i].output, &commits[i].state)) {
+			return false;
+		}
+	}
+	if (test || !commits_len) {
+		return true;
+	}
+
+	struct wlr_output_state *saved = calloc(commits_len, sizeof(struct wlr_output_state));
+	if (!saved) {
+		wlr_log(WLR_ERROR, "Could not commit outputs: insufficent memory");
+		return false;
+	}
+
+	for (i = 0; i < commits_len; i++) {
+		server_output_save_state(commits[i].output, &saved[i]);
+		if (!wlr_output_commit_state(commits[i].output, &commits[i].state)) {
+			break;
+		}
+	}
+
+	bool ok = i == commits_len;
+	if (!ok) {
+		wlr_log(WLR_ERROR, "Could not commit output %s, reverting the outputs already committed",
+				commits[i].output->name);
+		wlr_output_state_finish(&saved[i]);
+		while (i-- > 0) {
+			wlr_output_commit_state(commits[i].output, &saved[i]);
+			wlr_output_state_finish(&saved[i]);
+		}
+	} else {
+		for (i = 0; i < commits_len; i++) {
+			wlr_output_state_finish(&saved[i]);
+		}
+	}
+	free(saved);
+
+	return ok;
+}
+
 static void server_apply_output_config(
 		struct ptychite_server *server, struct wlr_output_configuration_v1 *output_config, bool test) {
-	bool ok = true;
+	struct server_output_commit *commits =
+			calloc(wl_list_length(&output_config->heads) + 1, sizeof(struct server_output_commit));
+	if (!commits) {
+		wlr_log(WLR_ERROR, "Could not apply output configuration: insufficent memory");
+		wlr_output_configuration_v1_send_failed(output_config);
+		return;
+	}
+
+	/* heads that only move within the layout need no commit, so docking only modesets the outputs that change */
+	size_t commits_len = 0;
+	struct wlr_output_configuration_head_v1 *head;
+	wl_list_for_each(head, &output_config->heads, link) {
+		if (!server_output_head_changed(head)) {
+			continue;
+		}
+
+		struct server_output_commit *commit = &commits[commits_len++];
+		commit->output = head->state.output;
+		wlr_output_state_init(&commit->state);
+		wlr_output_state_set_enabled(&commit->state, head->state.enabled);
+		if (!head->state.enabled) {
+			continue;
+		}
+
+		if (head->state.mode) {
+			wlr_output_state_set_mode(&commit->state, head->state.mode);
+		} else {
+			wlr_output_state_set_custom_mode(&commit->state, head->state.custom_mode.width,
+					head->state.custom_mode.height, head->state.custom_mode.refresh);
+		}
+		wlr_output_state_set_transform(&commit->state, head->state.transform);
+		wlr_output_state_set_scale(&commit->state, head->state.scale);
+		wlr_output_state_set_adaptive_sync_enabled(&commit->state, head->state.adaptive_sync_enabled);
+	}
+
+	bool ok = server_commit_outputs(commits, commits_len, test);
+
+	size_t i;
+	if (ok && !test) {
+		wl_list_for_each(head, &output_config->heads, link) {
+			struct wlr_output *output = head->state.output;
+			struct ptychite_monitor *monitor = output->data;
+			if (!head->state.enabled) {
+				continue;
+			}
+
+			if (!wlr_output_layout_get(server->output_layout, output) || monitor->geometry.x != head->state.x ||
+					monitor->geometry.y != head->state.y) {
+				server_add_output_to_layout(server, output, true, head->state.x, head->state.y);
+			}
+		}
+
+		for (i = 0; i < commits_len; i++) {
+			if (commits[i].state.committed & WLR_OUTPUT_STATE_SCALE) {
+				wlr_xcursor_manager_load(server->cursor_mgr, commits[i].state.scale);
+			}
+		}
+	}
+
+	for (i = 0; i < commits_len; i++) {
+		wlr_output_state_finish(&commits[i].state);
+	}
+	free(commits);
+
+	if (ok) {
+		wlr_output_configuration_v1_send_succeeded(output_config);
+	} else {
+		wlr_output_configuration_v1_send_failed(output_config);
+	}
+
+	server_update_monitors(server);
+}
+
+static void server_handle_output_mgr_apply(struct wl_listener *listener, void *data) {
+	struct ptychite_server *server = wl_container_of(listener, server, output_mgr_apply);
+	struct wlr_output_configuration_v1 *output_config = data;
+
+	server_apply_output_config(server, output_config, false);
+	wlr_output_configuration_v1_destroy(output_config);
+}
+
+static void server_handle_output_mgr_test(struct wl_listener *listener, void *data) {
+	struct ptychite_server *server = wl_container_of(listener, server, output_mgr_test);
+	struct wlr_output_configuration_v1 *output_config = data;
+
+	server_apply_output_config(server, output_config, true);
+	wlr_output_configuration_v1_destroy(output_config);
+}
+
+/* hotplugs and output commits emit a burst of layout changes, which are handled together once the burst is over */
+static void server_handle_layout_change(struct wl_listener *listener, void *data) {
+	struct ptychite_server *server = wl_container_of(listener, server, layout_change);
+
+	if (server->terminated || server->update_monitors_idle) {
+		return;
+	}
+
+	server->update_monitors_idle =
+			wl_event_loop_add_idle(wl_display_get_event_loop(server->display), server_handle_update_monitors_idle, server);
+}
+
+static bool server_output_matches(struct wlr_output *output, const char *match) {
+	if (!strcmp(match, "*") || !strcmp(match, output->name)) {
+		return true;
+	}
+
+	char description[256];
+	snprintf(description, sizeof(description), "%s %s %s", output->make ? output->make : "Unknown",
+			output->model ? output->model : "Unknown", output->serial ? output->serial : "Unknown");
+
+	return !strcmp(match, description);
+}
+
+/* outputs[i] is assigned the profile output in assigned[i], and each profile output is used at most once */
+static const struct ptychite_output_profile *server_match_output_profile(struct ptychite_server *server,
+		struct wlr_output **outputs, size_t outputs_len, const struct ptychite_output_profile_output **assigned) {
+	struct ptychite_output_profile *profile;
+	wl_array_for_each(profile, &server->compositor->config->monitors.profiles) {
+		if (profile->outputs_len != outputs_len) {
+			continue;
+		}
+
+		size_t i, j;
+		for (i = 0; i < outputs_len; i++) {
+			assigned[i] = NULL;
+		}
+
+		for (j = 0; j < profile->outputs_len; j++) {
+			for (i = 0; i < outputs_len; i++) {
+				if (!assigned[i] && server_output_matches(outputs[i], profile->outputs[j].match)) {
+					assigned[i] = &profile->outputs[j];
+					break;
+				}
+			}
+			if (i == outputs_len) {
+				break;
+			}
+		}
+
+		if (j == profile->outputs_len) {
+			return profile;
+		}
+	}
+
+	return NULL;
+}
+
+static struct wlr_output_mode *server_find_output_mode(
+		struct wlr_output *output, const struct ptychite_output_profile_output *profile_output) {
+	struct wlr_output_mode *mode, *best = NULL;
+	wl_list_for_each(mode, &output->modes, link) {
+		if (mode->width != profile_output->width || mode->height != profile_output->height) {
+			continue;
+		}
+
+		if (!best) {
+			best = mode;
+		} else if (profile_output->refresh) {
+			if (abs(mode->refresh - profile_output->refresh) < abs(best->refresh - profile_output->refresh)) {
+				best = mode;
+			}
+		} else if (mode->refresh > best->refresh) {
+			best = mode;
+		}
+	}
+
+	return best;
+}
+
+static void server_output_state_from_profile(struct ptychite_server *server, struct wlr_output *output,
+		const struct ptychite_output_profile_output *profile_output, struct wlr_output_state *state) {
+	wlr_output_state_set_enabled(state, !profile_output || profile_output->enabled);
+	if (profile_output && !profile_output->enabled) {
+		return;
+	}
+
+	struct wlr_output_mode *mode = NULL;
+	if (profile_output && profile_output->width) {
+		if (!(mode = server_find_output_mode(output, profile_output)) && wl_list_empty(&output->modes)) {
+			wlr_output_state_set_custom_mode(
+					state, profile_output->width, profile_output->height, profile_output->refresh);
+		}
+	}
+	if (!mode && !(state->committed & WLR_OUTPUT_STATE_MODE)) {
+		mode = wlr_output_preferred_mode(output);
+	}
+	if (mode) {
+		wlr_output_state_set_mode(state, mode);
+	}
 
-	struct wlr_output_configuration_head_v1 *head;
-	wl_list_for_each(head, &output_config->heads, link) {
-		struct wlr_output *output = head->state.output;
-		struct ptychite_monitor *monitor = output->data;
+	wlr_output_state_set_scale(state, profile_output && profile_output->scale > 0
+					? profile_output->scale
+					: server->compositor->config->monitors.default_scale);
+	wlr_output_state_set_transform(state, profile_output ? profile_output->transform : WL_OUTPUT_TRANSFORM_NORMAL);
+}
 
-		wlr_output_enable(output, head->state.enabled);
-		if (head->state.enabled) {
-			if (head->state.mode) {
-				wlr_output_set_mode(output, head->state.mode);
-			} else {
-				wlr_output_set_custom_mode(output, head->state.custom_mode.width, head->state.custom_mode.height,
-						head->state.custom_mode.refresh);
-			}
+static bool server_output_state_changes(struct wlr_output *output, const struct wlr_output_state *state) {
+	if (state->enabled != output->enabled) {
+		return true;
+	}
+	if (!state->enabled) {
+		return false;
+	}
 
-			if (monitor->geometry.x != head->state.x || monitor->geometry.y != head->state.y) {
-				wlr_output_layout_add(server->output_layout, output, head->state.x, head->state.y);
+	if (state->committed & WLR_OUTPUT_STATE_MODE) {
+		if (state->mode_type == WLR_OUTPUT_STATE_MODE_FIXED) {
+			if (state->mode != output->current_mode) {
+				return true;
 			}
-			wlr_output_set_transform(output, head->state.transform);
-			wlr_output_set_scale(output, head->state.scale);
-			wlr_xcursor_manager_load(server->cursor_mgr, head->state.scale);
-			wlr_output_enable_adaptive_sync(output, head->state.adaptive_sync_enabled);
-		}
-
-		if (test) {
-			ok &= wlr_output_test(output);
-			wlr_output_rollback(output);
-		} else {
-			ok &= wlr_output_commit(output);
+		} else if (state->custom_mode.width != output->width || state->custom_mode.height != output->height ||
+				(state->custom_mode.refresh && state->custom_mode.refresh != output->refresh)) {
+			return true;
 		}
 	}
 
-	if (ok) {
-		wlr_output_configuration_v1_send_succeeded(output_config);
-	} else {
-		wlr_output_configuration_v1_send_failed(output_config);
+	return state->scale != output->scale || state->transform != output->transform;
+}
+
+/* brings every connected output to the profile matching them. a new output is committed along with the others, so
+ * it comes up in its final mode, and the profile output it was assigned is returned for its position */
+static const struct ptychite_output_profile_output *server_apply_output_profile(
+		struct ptychite_server *server, struct wlr_output *new_output) {
+	size_t outputs_len = wl_list_length(&server->monitors) + (new_output ? 1 : 0);
+	struct wlr_output **outputs = calloc(outputs_len + 1, sizeof(struct wlr_output *));
+	const struct ptychite_output_profile_output **assigned =
+			calloc(outputs_len + 1, sizeof(struct ptychite_output_profile_output *));
+	struct server_output_commit *commits = calloc(outputs_len + 1, sizeof(struct server_output_commit));
+	if (!outputs || !assigned || !commits) {
+		wlr_log(WLR_ERROR, "Could not apply output profile: insufficent memory");
+		goto err_alloc;
 	}
 
-	server_update_monitors(server);
-}
+	size_t i = 0;
+	if (new_output) {
+		outputs[i++] = new_output;
+	}
+	struct ptychite_monitor *monitor;
+	wl_list_for_each(monitor, &server->monitors, link) {
+		outputs[i++] = monitor->output;
+	}
+
+	const struct ptychite_output_profile *profile =
+			server_match_output_profile(server, outputs, outputs_len, assigned);
+	if (profile) {
+		wlr_log(WLR_INFO, "Applying output profile '%s'", profile->name);
+	} else if (!new_output) {
+		goto err_alloc;
+	}
+
+	/* the new output is first, so its profiled mode is what its first commit carries */
+	size_t commits_len = 0;
+	for (i = 0; i < outputs_len; i++) {
+		struct server_output_commit *commit = &commits[commits_len];
+		commit->output = outputs[i];
+		wlr_output_state_init(&commit->state);
+		server_output_state_from_profile(server, outputs[i], assigned[i], &commit->state);
+		/* without a profile the other outputs keep whatever they were configured to */
+		if (outputs[i] != new_output && (!profile || !server_output_state_changes(outputs[i], &commit->state))) {
+			wlr_output_state_finish(&commit->state);
+			continue;
+		}
+		commits_len++;
+	}
 
-static void server_handle_output_mgr_apply(struct wl_listener *listener, void *data) {
-	struct ptychite_server *server = wl_container_of(listener, server, output_mgr_apply);
-	struct wlr_output_configuration_v1 *output_config = data;
+	bool ok = server_commit_outputs(commits, commits_len, false);
+	for (i = 0; i < commits_len; i++) {
+		wlr_output_state_finish(&commits[i].state);
+	}
 
-	server_apply_output_config(server, output_config, false);
-	wlr_output_configuration_v1_destroy(output_config);
+	const struct ptychite_output_profile_output *new_profile_output = NULL;
+	if (ok) {
+		for (i = 0; i < outputs_len; i++) {
+			if (outputs[i] == new_output) {
+				new_profile_output = assigned[i];
+			} else if (assigned[i] && assigned[i]->enabled && assigned[i]->position_set) {
+				server_add_output_to_layout(server, outputs[i], true, assigned[i]->x, assigned[i]->y);
+			}
+		}
+	} else if (new_output) {
+		/* the profile asked for something the hardware refused, the new output still has to come up */
+		wlr_log(WLR_ERROR, "Could not apply output profile '%s'", profile ? profile->name : "default");
+		struct wlr_output_state state;
+		wlr_output_state_init(&state);
+		server_output_state_from_profile(server, new_output, NULL, &state);
+		wlr_output_commit_state(new_output, &state);
+		wlr_output_state_finish(&state);
+	}
+
+	free(commits);
+	free(assigned);
+	free(outputs);
+	return new_profile_output;
+
+err_alloc:
+	free(commits);
+	free(assigned);
+	free(outputs);
+	return NULL;
 }
 
-static void server_handle_output_mgr_test(struct wl_listener *listener, void *data) {
-	struct ptychite_server *server = wl_container_of(listener, server, output_mgr_test);
-	struct wlr_output_configuration_v1 *output_config = data;
+static void server_handle_output_profile_idle(void *data) {
+	struct ptychite_server *server = data;
 
-	server_apply_output_config(server, output_config, true);
-	wlr_output_configuration_v1_destroy(output_config);
+	server->output_profile_idle = NULL;
+	server_apply_output_profile(server, NULL);
 }
 
-static void server_handle_layout_change(struct wl_listener *listener, void *data) {
-	struct ptychite_server *server = wl_container_of(listener, server, layout_change);
+void ptychite_server_queue_output_profile(struct ptychite_server *server) {
+	if (server->terminated || server->output_profile_idle) {
+		return;
+	}
 
-	server_update_monitors(server);
+	server->output_profile_idle = wl_event_loop_add_idle(
+			wl_display_get_event_loop(server->display), server_handle_output_profile_idle, server);
 }
 
 static void server_handle_new_output(struct wl_listener *listener, void *data) {
@@ -434,6 +1176,7 @@ static void server_handle_new_output(struct wl_listener *listener, void *data) {
 	}
 
 	wl_list_init(&monitor->workspaces);
+	wl_list_init(&monitor->pending_resizes);
 	if (!(monitor->current_workspace = ptychite_monitor_add_workspace(monitor))) {
 		wlr_log(WLR_ERROR, "Could not initialize output: insufficent memory");
 		free(monitor);
@@ -447,23 +1190,30 @@ static void server_handle_new_output(struct wl_listener *listener, void *data) {
 		return;
 	}
 
-	struct wlr_output_state state;
-	wlr_output_state_init(&state);
-	wlr_output_state_set_enabled(&state, true);
+	if (!(monitor->scene_tree = wlr_scene_tree_create(server->layers.tiled))) {
+		wlr_log(WLR_ERROR, "Could not initialize output: insufficent memory");
+		free(monitor->current_workspace);
+		free(monitor);
+		return;
+	}
 
-	struct wlr_output_mode *mode = wlr_output_preferred_mode(output);
-	if (mode) {
-		wlr_output_state_set_mode(&state, mode);
+	if (ptychite_monitor_init_timers(monitor, wl_display_get_event_loop(server->display))) {
+		wlr_log(WLR_ERROR, "Could not initialize output: insufficent memory");
+		wlr_scene_node_destroy(&monitor->scene_tree->node);
+		free(monitor->current_workspace);
+		free(monitor);
+		return;
 	}
-	wlr_output_state_set_scale(&state, server->compositor->config->monitors.default_scale);
 
-	wlr_output_commit_state(output, &state);
-	wlr_output_state_finish(&state);
+	/* the matching profile is applied in the very first commit, rather than after a modeset to the preferred mode */
+	const struct ptychite_output_profile_output *profile_output = server_apply_output_profile(server, output);
 
 	output->data = monitor;
 	monitor->output = output;
 	monitor->server = server;
 	wl_list_init(&monitor->views);
+	ptychite_hit_grid_init(&monitor->hit_grid);
+	ptychite_monitor_init_stats(monitor);
 
 	ptychite_monitor_rig(monitor);
 
@@ -492,9 +1242,46 @@ static void server_handle_new_output(struct wl_listener *listener, void *data) {
 		}
 	}
 
-	struct wlr_output_layout_output *l_output = wlr_output_layout_add_auto(server->output_layout, output);
-	struct wlr_scene_output *scene_output = wlr_scene_output_create(server->scene, output);
-	wlr_scene_output_layout_add_output(server->scene_layout, l_output, scene_output);
+	/* an output its profile disables stays out of the layout until something enables it */
+	if (!profile_output || profile_output->enabled) {
+		server_add_output_to_layout(server, output, profile_output && profile_output->position_set,
+				profile_output ? profile_output->x : 0, profile_output ? profile_output->y : 0);
+	}
+}
+
+struct server_popup {
+	struct ptychite_server *server;
+	struct wlr_xdg_popup *xdg_popup;
+	struct wlr_box geometry;
+	struct wl_listener commit;
+	struct wl_listener unmap;
+	struct wl_listener destroy;
+};
+
+/* popups reach past the view they belong to, so the grid only has to be rebuilt when one moves, resizes or goes */
+static void server_popup_handle_commit(struct wl_listener *listener, void *data) {
+	struct server_popup *popup = wl_container_of(listener, popup, commit);
+
+	if (!wlr_box_equal(&popup->geometry, &popup->xdg_popup->current.geometry)) {
+		popup->geometry = popup->xdg_popup->current.geometry;
+		ptychite_server_invalidate_hit_grids(popup->server);
+	}
+}
+
+static void server_popup_handle_unmap(struct wl_listener *listener, void *data) {
+	struct server_popup *popup = wl_container_of(listener, popup, unmap);
+
+	popup->geometry = (struct wlr_box){0};
+	ptychite_server_invalidate_hit_grids(popup->server);
+}
+
+static void server_popup_handle_destroy(struct wl_listener *listener, void *data) {
+	struct server_popup *popup = wl_container_of(listener, popup, destroy);
+
+	wl_list_remove(&popup->commit.link);
+	wl_list_remove(&popup->unmap.link);
+	wl_list_remove(&popup->destroy.link);
+	free(popup);
 }
 
 static void server_handle_new_xdg_surface(struct wl_listener *listener, void *data) {
@@ -507,6 +1294,20 @@ static void server_handle_new_xdg_surface(struct wl_listener *listener, void *da
 		struct wlr_scene_tree *parent_tree = parent->data;
 		struct wlr_scene_tree *scene_tree = wlr_scene_xdg_surface_create(parent_tree, xdg_surface);
 		xdg_surface->data = scene_tree;
+
+		struct server_popup *popup = calloc(1, sizeof(struct server_popup));
+		if (!popup) {
+			wlr_log(WLR_ERROR, "Could not initialize popup: insufficent memory");
+			return;
+		}
+		popup->server = server;
+		popup->xdg_popup = xdg_surface->popup;
+		popup->commit.notify = server_popup_handle_commit;
+		wl_signal_add(&xdg_surface->surface->events.commit, &popup->commit);
+		popup->unmap.notify = server_popup_handle_unmap;
+		wl_signal_add(&xdg_surface->surface->events.unmap, &popup->unmap);
+		popup->destroy.notify = server_popup_handle_destroy;
+		wl_signal_add(&xdg_surface->events.destroy, &popup->destroy);
 		return;
 	}
 	assert(xdg_surface->role == WLR_XDG_SURFACE_ROLE_TOPLEVEL);
@@ -550,10 +1351,164 @@ static void server_handle_new_xdg_surface(struct wl_listener *listener, void *da
 	ptychite_view_rig(view, xdg_surface);
 }
 
+struct server_idle_inhibitor {
+	struct wl_list link;
+	struct ptychite_server *server;
+	struct wlr_idle_inhibitor_v1 *inhibitor;
+	struct wl_listener destroy;
+};
+
+/* inhibitors only count while their surface is actually shown, a video on another workspace does not keep the
+ * screen on */
+static bool server_idle_inhibitor_visible(struct wlr_idle_inhibitor_v1 *inhibitor) {
+	struct wlr_surface *surface = wlr_surface_get_root_surface(inhibitor->surface);
+	struct wlr_xdg_surface *xdg_surface = wlr_xdg_surface_try_from_wlr_surface(surface);
+	if (!xdg_surface || !xdg_surface->data) {
+		return true;
+	}
+
+	struct wlr_scene_tree *scene_tree = xdg_surface->data;
+	int x, y;
+	return wlr_scene_node_coords(&scene_tree->node, &x, &y);
+}
+
+static bool server_check_idle_inhibited(struct ptychite_server *server) {
+	bool inhibited = false;
+
+	struct server_idle_inhibitor *idle_inhibitor;
+	wl_list_for_each(idle_inhibitor, &server->idle_inhibitors, link) {
+		if (server_idle_inhibitor_visible(idle_inhibitor->inhibitor)) {
+			inhibited = true;
+			break;
+		}
+	}
+
+	wlr_idle_notifier_v1_set_inhibited(server->idle_notifier, inhibited);
+	return inhibited;
+}
+
+static void server_idle_inhibitor_handle_destroy(struct wl_listener *listener, void *data) {
+	struct server_idle_inhibitor *idle_inhibitor = wl_container_of(listener, idle_inhibitor, destroy);
+	struct ptychite_server *server = idle_inhibitor->server;
+
+	wl_list_remove(&idle_inhibitor->destroy.link);
+	wl_list_remove(&idle_inhibitor->link);
+	free(idle_inhibitor);
+
+	server_check_idle_inhibited(server);
+}
+
 static void server_handle_idle_inhibitor_create(struct wl_listener *listener, void *data) {
-	struct wlr_idle_inhibitor_v1 *idle_inhibitor = data;
+	struct ptychite_server *server = wl_container_of(listener, server, idle_inhibitor_create);
+	struct wlr_idle_inhibitor_v1 *inhibitor = data;
+
+	struct server_idle_inhibitor *idle_inhibitor = calloc(1, sizeof(struct server_idle_inhibitor));
+	if (!idle_inhibitor) {
+		wlr_log(WLR_ERROR, "Could not track idle inhibitor: insufficent memory");
+		return;
+	}
+
+	idle_inhibitor->server = server;
+	idle_inhibitor->inhibitor = inhibitor;
+	idle_inhibitor->destroy.notify = server_idle_inhibitor_handle_destroy;
+	wl_signal_add(&inhibitor->events.destroy, &idle_inhibitor->destroy);
+	wl_list_insert(&server->idle_inhibitors, &idle_inhibitor->link);
+
+	server_check_idle_inhibited(server);
+}
+
+static void server_handle_output_power_set_mode(struct wl_listener *listener, void *data) {
+	struct ptychite_server *server = wl_container_of(listener, server, output_power_set_mode);
+	struct wlr_output_power_v1_set_mode_event *event = data;
+
+	struct ptychite_monitor *monitor = event->output->data;
+	if (!monitor) {
+		return;
+	}
+
+	ptychite_monitor_set_power(monitor, event->mode == ZWLR_OUTPUT_POWER_V1_MODE_ON);
+	ptychite_server_update_power(server);
+}
+
+static void server_set_outputs_power(struct ptychite_server *server, bool on) {
+	struct ptychite_monitor *monitor;
+	wl_list_for_each(monitor, &server->monitors, link) {
+		ptychite_monitor_set_power(monitor, on);
+	}
+
+	ptychite_server_update_power(server);
+}
+
+static int server_handle_dpms_timer(void *data) {
+	struct ptychite_server *server = data;
+
+	int timeout = server->compositor->config->monitors.dpms_timeout * 1000;
+	if (!timeout || server->outputs_off) {
+		return 0;
+	}
+
+	/* activity only stamps a time, the timer rearms itself for whatever is left rather than being reset per event */
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double idle_ms = ptychite_timespec_diff_ms(&server->last_activity, &now);
+	if (idle_ms < timeout) {
+		wl_event_source_timer_update(server->dpms_timer, timeout - idle_ms + 1);
+		return 0;
+	}
+
+	if (server_check_idle_inhibited(server)) {
+		wl_event_source_timer_update(server->dpms_timer, timeout);
+		return 0;
+	}
+
+	wlr_log(WLR_INFO, "Idle for %d seconds, powering off outputs", timeout / 1000);
+	server_set_outputs_power(server, false);
+
+	return 0;
+}
+
+void ptychite_server_configure_idle(struct ptychite_server *server) {
+	int timeout = server->compositor->config->monitors.dpms_timeout * 1000;
+
+	clock_gettime(CLOCK_MONOTONIC, &server->last_activity);
+	wl_event_source_timer_update(server->dpms_timer, server->outputs_off ? 0 : timeout);
+}
+
+void ptychite_server_notify_activity(struct ptychite_server *server) {
+	wlr_idle_notifier_v1_notify_activity(server->idle_notifier, server->seat);
+	clock_gettime(CLOCK_MONOTONIC, &server->last_activity);
+
+	if (server->outputs_off) {
+		server_set_outputs_power(server, true);
+	}
+}
+
+/* while every output is off nothing the tick redraws can be seen, so the tick and the user module polling it
+ * drives stop until an output comes back */
+void ptychite_server_update_power(struct ptychite_server *server) {
+	bool off = false;
 
-	// TODO
+	struct ptychite_monitor *monitor;
+	wl_list_for_each(monitor, &server->monitors, link) {
+		if (monitor->output->enabled) {
+			off = false;
+			break;
+		}
+		off |= monitor->power.off;
+	}
+
+	if (off == server->outputs_off) {
+		return;
+	}
+	server->outputs_off = off;
+
+	if (off) {
+		wl_event_source_timer_update(server->time_tick, 0);
+		wl_event_source_timer_update(server->dpms_timer, 0);
+	} else {
+		server_time_tick_update(server);
+		ptychite_server_configure_idle(server);
+	}
 }
 
 static void server_handle_new_xdg_decoration(struct wl_listener *listener, void *data) {
@@ -566,27 +1521,48 @@ static void server_handle_cursor_motion(struct wl_listener *listener, void *data
 	struct ptychite_server *server = wl_container_of(listener, server, cursor_motion);
 	struct wlr_pointer_motion_event *event = data;
 
+	if (server->recorder) {
+		ptychite_recorder_motion(server->recorder, event);
+	}
 	wlr_cursor_move(server->cursor, &event->pointer->base, event->delta_x, event->delta_y);
-	server_process_cursor_motion(server, event->time_msec);
+	server_stamp_pointer_input(server);
+	ptychite_server_notify_activity(server);
+	server_queue_cursor_motion(server, event->time_msec);
 }
 
 static void server_handle_cursor_motion_absolute(struct wl_listener *listener, void *data) {
 	struct ptychite_server *server = wl_container_of(listener, server, cursor_motion_absolute);
 	struct wlr_pointer_motion_absolute_event *event = data;
 
+	if (server->recorder) {
+		ptychite_recorder_motion_absolute(server->recorder, event);
+	}
 	wlr_cursor_warp_absolute(server->cursor, &event->pointer->base, event->x, event->y);
-	server_process_cursor_motion(server, event->time_msec);
+	server_stamp_pointer_input(server);
+	ptychite_server_notify_activity(server);
+	server_queue_cursor_motion(server, event->time_msec);
 }
 
 static void server_handle_cursor_button(struct wl_listener *listener, void *data) {
 	struct ptychite_server *server = wl_container_of(listener, server, cursor_button);
 	struct wlr_pointer_button_event *event = data;
 
+	if (server->recorder) {
+		ptychite_recorder_button(server->recorder, event);
+	}
+	server_stamp_pointer_input(server);
+	ptychite_server_notify_activity(server);
+	ptychite_server_flush_cursor_motion(server);
+
 	if (event->state == WLR_BUTTON_RELEASED) {
 		if (server->cursor_mode != PTYCHITE_CURSOR_PASSTHROUGH) {
+			if (server->grabbed_view) {
+				ptychite_view_flush_interactive_resize(server->grabbed_view);
+			}
 			server->cursor_mode = PTYCHITE_CURSOR_PASSTHROUGH;
 			server->grabbed_view = NULL;
-			wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "left_ptr");
+			ptychite_server_set_cursor_image(server, "left_ptr");
+			ptychite_server_check_suspended(server);
 		}
 	}
 
@@ -599,8 +1575,9 @@ static void server_handle_cursor_button(struct wl_listener *listener, void *data
 		case PTYCHITE_ELEMENT_VIEW:
 			if (event->state == WLR_BUTTON_PRESSED) {
 				struct ptychite_view *view = ptychite_element_get_view(element);
+				/* the buffers of a resize snapshot stand in for the view but belong to no surface */
 				struct wlr_scene_surface *scene_surface = wlr_scene_surface_try_from_buffer(scene_buffer);
-				ptychite_view_focus(view, scene_surface->surface);
+				ptychite_view_focus(view, scene_surface ? scene_surface->surface : view->xdg_toplevel->base->surface);
 
 				struct wlr_keyboard *keyboard = wlr_seat_get_keyboard(server->seat);
 				if (!keyboard) {
@@ -634,6 +1611,13 @@ static void server_handle_cursor_axis(struct wl_listener *listener, void *data)
 	struct ptychite_server *server = wl_container_of(listener, server, cursor_axis);
 	struct wlr_pointer_axis_event *event = data;
 
+	if (server->recorder) {
+		ptychite_recorder_axis(server->recorder, event);
+	}
+	server_stamp_pointer_input(server);
+	ptychite_server_notify_activity(server);
+	ptychite_server_flush_cursor_motion(server);
+
 	wlr_seat_pointer_notify_axis(
 			server->seat, event->time_msec, event->orientation, event->delta, event->delta_discrete, event->source);
 }
@@ -641,6 +1625,10 @@ static void server_handle_cursor_axis(struct wl_listener *listener, void *data)
 static void server_handle_cursor_frame(struct wl_listener *listener, void *data) {
 	struct ptychite_server *server = wl_container_of(listener, server, cursor_frame);
 
+	if (server->recorder) {
+		ptychite_recorder_frame(server->recorder);
+	}
+
 	wlr_seat_pointer_notify_frame(server->seat);
 }
 
@@ -648,6 +1636,10 @@ static void server_handle_new_input(struct wl_listener *listener, void *data) {
 	struct ptychite_server *server = wl_container_of(listener, server, new_input);
 	struct wlr_input_device *device = data;
 
+	if (server->recorder) {
+		ptychite_recorder_add_device(server->recorder, device);
+	}
+
 	switch (device->type) {
 	case WLR_INPUT_DEVICE_KEYBOARD:
 		server_new_keyboard(server, device);
@@ -673,6 +1665,7 @@ static void server_handle_seat_request_cursor(struct wl_listener *listener, void
 
 	if (focused_client == event->seat_client) {
 		wlr_cursor_set_surface(server->cursor, event->surface, event->hotspot_x, event->hotspot_y);
+		server->cursor_image = NULL;
 	}
 }
 
@@ -739,18 +1732,18 @@ void ptychite_server_tiling_change_views_in_master(struct ptychite_server *serve
 	}
 
 	struct ptychite_workspace *workspace = monitor->current_workspace;
-	int views_in_master = workspace->tiling.traditional.views_in_master + delta;
+	int views_in_master = workspace->tiling.params.traditional.views_in_master + delta;
 	if (views_in_master > 100) {
 		views_in_master = 100;
 	} else if (views_in_master < 0) {
 		views_in_master = 0;
 	}
 
-	if (views_in_master == workspace->tiling.traditional.views_in_master) {
+	if (views_in_master == workspace->tiling.params.traditional.views_in_master) {
 		return;
 	}
 
-	workspace->tiling.traditional.views_in_master = views_in_master;
+	workspace->tiling.params.traditional.views_in_master = views_in_master;
 	ptychite_monitor_tile(monitor);
 }
 
@@ -761,18 +1754,18 @@ void ptychite_server_tiling_change_master_factor(struct ptychite_server *server,
 	}
 
 	struct ptychite_workspace *workspace = monitor->current_workspace;
-	double master_factor = workspace->tiling.traditional.master_factor + delta;
+	double master_factor = workspace->tiling.params.traditional.master_factor + delta;
 	if (master_factor > 0.95) {
 		master_factor = 0.95;
 	} else if (master_factor < 0.05) {
 		master_factor = 0.05;
 	}
 
-	if (master_factor == workspace->tiling.traditional.master_factor) {
+	if (master_factor == workspace->tiling.params.traditional.master_factor) {
 		return;
 	}
 
-	workspace->tiling.traditional.master_factor = master_factor;
+	workspace->tiling.params.traditional.master_factor = master_factor;
 	ptychite_monitor_tile(monitor);
 }
 
@@ -794,6 +1787,11 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 	server->terminated = false;
 
 	wl_array_init(&server->keys);
+	wl_list_init(&server->keymaps);
+	wl_list_init(&server->windows);
+	wl_list_init(&server->children);
+	wl_list_init(&server->launches);
+	wl_list_init(&server->launch_stats);
 	ptychite_hash_map_init(&server->applications, ptychite_murmur3_string_hash);
 	ptychite_hash_map_init(&server->icons, ptychite_murmur3_string_hash);
 
@@ -801,11 +1799,22 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 		return -1;
 	};
 
+	if (!(server->xkb_context = xkb_context_new(XKB_CONTEXT_NO_FLAGS))) {
+		wlr_log(WLR_ERROR, "failed to create xkb_context");
+		return -1;
+	}
+
 	if (!(server->backend = wlr_backend_autocreate(server->display, &server->session))) {
 		wlr_log(WLR_ERROR, "failed to create wlr_backend");
 		return -1;
 	}
 
+	const char *record_path = getenv("PTYCHITE_RECORD");
+	if (record_path && !(server->recorder = ptychite_recorder_create(record_path))) {
+		wlr_log(WLR_ERROR, "failed to start input recording");
+		return -1;
+	}
+
 	if (!(server->renderer = wlr_renderer_autocreate(server->backend))) {
 		wlr_log(WLR_ERROR, "failed to create wlr_renderer");
 		return -1;
@@ -839,6 +1848,12 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 	server->output_mgr_test.notify = server_handle_output_mgr_test;
 	wl_signal_add(&server->output_mgr->events.test, &server->output_mgr_test);
 
+	if (!(server->output_power_mgr = wlr_output_power_manager_v1_create(server->display))) {
+		return -1;
+	}
+	server->output_power_set_mode.notify = server_handle_output_power_set_mode;
+	wl_signal_add(&server->output_power_mgr->events.set_mode, &server->output_power_set_mode);
+
 	wl_list_init(&server->monitors);
 	server->new_output.notify = server_handle_new_output;
 	wl_signal_add(&server->backend->events.new_output, &server->new_output);
@@ -869,14 +1884,18 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 		return -1;
 	}
 
-	/* server->idle = wlr_idle_create(server->display); */
-	/* server->idle_notifier = wlr_idle_notifier_v1_create(server->display); */
-	/* server->idle_inhibit_mgr = wlr_idle_inhibit_v1_create(server->display); */
-	/* server->idle_inhibitor_create.notify = server_handle_idle_inhibitor_create; */
-	/* wl_signal_add(&server->idle_inhibit_mgr->events.new_inhibitor, &server->idle_inhibitor_create); */
+	if (!(server->idle_notifier = wlr_idle_notifier_v1_create(server->display))) {
+		return -1;
+	}
+	if (!(server->idle_inhibit_mgr = wlr_idle_inhibit_v1_create(server->display))) {
+		return -1;
+	}
+	wl_list_init(&server->idle_inhibitors);
+	server->idle_inhibitor_create.notify = server_handle_idle_inhibitor_create;
+	wl_signal_add(&server->idle_inhibit_mgr->events.new_inhibitor, &server->idle_inhibitor_create);
 
 	wl_list_init(&server->views);
-	server->xdg_shell = wlr_xdg_shell_create(server->display, 3);
+	server->xdg_shell = wlr_xdg_shell_create(server->display, 6);
 	server->new_xdg_surface.notify = server_handle_new_xdg_surface;
 	wl_signal_add(&server->xdg_shell->events.new_surface, &server->new_xdg_surface);
 
@@ -896,7 +1915,7 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 	server->cursor_frame.notify = server_handle_cursor_frame;
 	wl_signal_add(&server->cursor->events.frame, &server->cursor_frame);
 
-	wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "left_ptr");
+	ptychite_server_set_cursor_image(server, "left_ptr");
 
 	wl_list_init(&server->keyboards);
 	server->new_input.notify = server_handle_new_input;
@@ -917,6 +1936,11 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 	wlr_fractional_scale_manager_v1_create(server->display, 1);
 	wlr_data_control_manager_v1_create(server->display);
 
+	if ((server->xdg_activation = wlr_xdg_activation_v1_create(server->display))) {
+		server->xdg_activation_request.notify = server_handle_xdg_activation_request;
+		wl_signal_add(&server->xdg_activation->events.request_activate, &server->xdg_activation_request);
+	}
+
 	struct wlr_server_decoration_manager *server_decoration_manager =
 			wlr_server_decoration_manager_create(server->display);
 	if (!server_decoration_manager) {
@@ -954,6 +1978,10 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 	wlr_scene_node_set_enabled(&server->switcher.base.element.scene_tree->node, false);
 	wlr_scene_node_set_enabled(&server->switcher.sub_switcher.element.scene_tree->node, false);
 
+	if (ptychite_hud_init(&server->hud, server)) {
+		return -1;
+	}
+
 	if (!(server->time_tick = wl_event_loop_add_timer(
 				  wl_display_get_event_loop(server->display), server_time_tick_update, server))) {
 		return -1;
@@ -961,6 +1989,17 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 	server->seconds = 0;
 	server_time_tick_update(server);
 
+	if (!(server->sigchld = wl_event_loop_add_signal(
+				  wl_display_get_event_loop(server->display), SIGCHLD, server_handle_sigchld, server))) {
+		return -1;
+	}
+
+	if (!(server->dpms_timer = wl_event_loop_add_timer(
+				  wl_display_get_event_loop(server->display), server_handle_dpms_timer, server))) {
+		return -1;
+	}
+	ptychite_server_configure_idle(server);
+
 	if (!ptychite_dbus_init(server)) {
 		wlr_log(WLR_INFO, "Successfully initialized dbus.");
 	} else {
@@ -984,16 +2023,48 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 
 	setenv("WAYLAND_DISPLAY", socket, true);
 
+	const char *replay_path = getenv("PTYCHITE_REPLAY");
+	if (replay_path && !(server->replay = ptychite_replay_create(server, replay_path))) {
+		wlr_log(WLR_ERROR, "failed to load input recording");
+	}
+
 	wlr_log(WLR_INFO, "Running ptychite on WAYLAND_DISPLAY=%s", socket);
 	wl_display_run(server->display);
 	server->terminated = true;
 
+	struct server_child *child, *child_tmp;
+	wl_list_for_each_safe(child, child_tmp, &server->children, link) {
+		server_child_destroy(child);
+	}
+	wl_event_source_remove(server->sigchld);
+
+	if (server->replay) {
+		ptychite_replay_destroy(server->replay);
+	}
+	if (server->recorder) {
+		ptychite_recorder_destroy(server->recorder);
+	}
+
+	ptychite_hud_finish(&server->hud);
 	wl_display_destroy_clients(server->display);
 	wlr_scene_node_destroy(&server->scene->tree.node);
 	wlr_xcursor_manager_destroy(server->cursor_mgr);
 	wlr_output_layout_destroy(server->output_layout);
 	wl_display_destroy(server->display);
 
+	struct server_keymap *keymap, *keymap_tmp;
+	wl_list_for_each_safe(keymap, keymap_tmp, &server->keymaps, link) {
+		server_keymap_destroy(keymap);
+	}
+	xkb_context_unref(server->xkb_context);
+
+	struct ptychite_launch_stats *stats, *stats_tmp;
+	wl_list_for_each_safe(stats, stats_tmp, &server->launch_stats, link) {
+		wl_list_remove(&stats->link);
+		free(stats->app_id);
+		free(stats);
+	}
+
 	if (server->dbus.active) {
 		ptychite_dbus_finish(server);
 	}
@@ -1002,31 +2073,44 @@ int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite
 }
 
 void ptychite_server_configure_keyboards(struct ptychite_server *server) {
-	struct ptychite_config *config = server->compositor->config;
-
 	struct ptychite_keyboard *keyboard;
 	wl_list_for_each(keyboard, &server->keyboards, link) {
-		wlr_keyboard_set_repeat_info(keyboard->keyboard, config->keyboard.repeat.rate, config->keyboard.repeat.delay);
+		server_configure_keyboard(server, keyboard);
+	}
+
+	struct server_keymap *keymap, *keymap_tmp;
+	wl_list_for_each_safe(keymap, keymap_tmp, &server->keymaps, link) {
+		bool used = false;
+		wl_list_for_each(keyboard, &server->keyboards, link) {
+			if (keyboard->keyboard->keymap == keymap->keymap) {
+				used = true;
+				break;
+			}
+		}
+		if (!used) {
+			server_keymap_destroy(keymap);
+		}
+	}
+}
 
-		struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-		if (!context) {
+void ptychite_server_switch_keyboard_layout(struct ptychite_server *server, int delta) {
+	struct ptychite_keyboard *keyboard;
+	wl_list_for_each(keyboard, &server->keyboards, link) {
+		struct wlr_keyboard *wlr_keyboard = keyboard->keyboard;
+		if (!wlr_keyboard->keymap) {
 			continue;
 		}
-		const struct xkb_rule_names rule_names = {
-				.options = config->keyboard.xkb.options,
-				.rules = NULL,
-				.layout = NULL,
-				.model = NULL,
-				.variant = NULL,
-		};
-		struct xkb_keymap *keymap = xkb_keymap_new_from_names(context, &rule_names, XKB_KEYMAP_COMPILE_NO_FLAGS);
-		if (!keymap) {
-			xkb_context_unref(context);
+
+		/* every layout of a keymap is already compiled in as a group, so switching is just a modifier update */
+		int layouts = xkb_keymap_num_layouts(wlr_keyboard->keymap);
+		if (layouts < 2) {
 			continue;
 		}
-		wlr_keyboard_set_keymap(keyboard->keyboard, keymap);
-		xkb_keymap_unref(keymap);
-		xkb_context_unref(context);
+		int layout = xkb_state_serialize_layout(wlr_keyboard->xkb_state, XKB_STATE_LAYOUT_EFFECTIVE);
+		layout = ((layout + delta) % layouts + layouts) % layouts;
+
+		wlr_keyboard_notify_modifiers(wlr_keyboard, wlr_keyboard->modifiers.depressed,
+				wlr_keyboard->modifiers.latched, wlr_keyboard->modifiers.locked, layout);
 	}
 }
 
@@ -1047,6 +2131,7 @@ void ptychite_server_configure_panels(struct ptychite_server *server) {
 		ptychite_monitor_tile(monitor);
 	}
 
+	ptychite_server_invalidate_hit_grids(server);
 	if (server->control->base.element.scene_tree->node.enabled) {
 		ptychite_control_draw_auto(server->control);
 	}
@@ -1084,6 +2169,139 @@ void ptychite_server_retile(struct ptychite_server *server) {
 	}
 }
 
+static void server_handle_idle_flush(void *data) {
+	struct ptychite_server *server = data;
+	server->idle_flush = NULL;
+
+	struct ptychite_monitor *monitor;
+	wl_list_for_each(monitor, &server->monitors, link) {
+		if (monitor->needs_tile) {
+			ptychite_monitor_tile_now(monitor);
+		}
+	}
+
+	if (server->needs_cursor_check) {
+		server->needs_cursor_check = false;
+		server->pending_window_motion = false;
+		server_process_cursor_motion(server, 0);
+	}
+
+	if (server->needs_suspend_check) {
+		server->needs_suspend_check = false;
+		struct ptychite_view *view;
+		wl_list_for_each(view, &server->views, server_link) {
+			ptychite_view_update_suspended(view);
+		}
+
+		/* whatever can hide or show a view can also hide or show the surface holding an idle inhibitor */
+		if (!wl_list_empty(&server->idle_inhibitors)) {
+			server_check_idle_inhibited(server);
+		}
+	}
+}
+
+void ptychite_server_schedule_flush(struct ptychite_server *server) {
+	if (server->idle_flush || server->terminated) {
+		return;
+	}
+
+	server->idle_flush =
+			wl_event_loop_add_idle(wl_display_get_event_loop(server->display), server_handle_idle_flush, server);
+}
+
+void ptychite_server_set_cursor_image(struct ptychite_server *server, const char *name) {
+	if (server->cursor_image && !strcmp(server->cursor_image, name)) {
+		return;
+	}
+
+	wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, name);
+	server->cursor_image = name;
+}
+
+void ptychite_server_invalidate_hit_grids(struct ptychite_server *server) {
+	struct ptychite_monitor *monitor;
+	wl_list_for_each(monitor, &server->monitors, link) {
+		monitor->hit_grid.dirty = true;
+	}
+}
+
 void ptychite_server_check_cursor(struct ptychite_server *server) {
-	server_process_cursor_motion(server, 0);
+	ptychite_server_invalidate_hit_grids(server);
+
+	/* retiles and rearrangements come in bursts, so the hit test is done once they have settled */
+	server->needs_cursor_check = true;
+	ptychite_server_check_suspended(server);
+}
+
+void ptychite_server_check_suspended(struct ptychite_server *server) {
+	server->needs_suspend_check = true;
+	ptychite_server_schedule_flush(server);
+}
+
+void ptychite_server_spawn(struct ptychite_server *server, char **args) {
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	char **env = NULL;
+	char *token_var = NULL, *startup_var = NULL;
+	struct server_launch *launch = server_launch_create(server);
+	if (launch) {
+		const char *name = wlr_xdg_activation_token_v1_get_name(launch->token);
+		token_var = ptychite_asprintf("XDG_ACTIVATION_TOKEN=%s", name);
+		startup_var = ptychite_asprintf("DESKTOP_STARTUP_ID=%s", name);
+
+		size_t environ_l;
+		for (environ_l = 0; environ[environ_l]; environ_l++) {
+			;
+		}
+		if (token_var && startup_var && (env = calloc(environ_l + 3, sizeof(char *)))) {
+			size_t i, j = 0;
+			for (i = 0; i < environ_l; i++) {
+				if (!strncmp(environ[i], "XDG_ACTIVATION_TOKEN=", strlen("XDG_ACTIVATION_TOKEN=")) ||
+						!strncmp(environ[i], "DESKTOP_STARTUP_ID=", strlen("DESKTOP_STARTUP_ID="))) {
+					continue;
+				}
+				env[j++] = environ[i];
+			}
+			env[j++] = token_var;
+			env[j++] = startup_var;
+		}
+	}
+
+	pid_t pid = ptychite_spawn(args, env);
+	free(env);
+	free(token_var);
+	free(startup_var);
+	if (pid < 0) {
+		wlr_log_errno(WLR_ERROR, "Could not spawn '%s'", args[0]);
+		if (launch) {
+			wlr_xdg_activation_token_v1_destroy(launch->token);
+		}
+		return;
+	}
+	if (launch) {
+		launch->pid = pid;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	wlr_log(WLR_DEBUG, "Spawned '%s' as %d in %.3f ms", args[0], pid, ptychite_timespec_diff_ms(&start, &end));
+
+	struct server_child *child = calloc(1, sizeof(struct server_child));
+	if (!child) {
+		wlr_log(WLR_ERROR, "Could not track child %d: insufficent memory", pid);
+		return;
+	}
+	child->server = server;
+	child->pid = pid;
+	wl_list_insert(&server->children, &child->link);
+
+	/* without pidfd support, the child is reaped on SIGCHLD instead */
+	if ((child->pidfd = ptychite_pidfd_open(pid)) < 0) {
+		return;
+	}
+	if (!(child->source = wl_event_loop_add_fd(wl_display_get_event_loop(server->display), child->pidfd,
+				  WL_EVENT_READABLE, server_handle_child_exit, child))) {
+		close(child->pidfd);
+		child->pidfd = -1;
+	}
 }
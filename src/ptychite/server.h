@@ -16,6 +16,19 @@
 struct ptychite_compositor;
 struct ptychite_server;
 struct ptychite_action;
+struct ptychite_view;
+
+#define PTYCHITE_LAUNCH_HISTOGRAM_BUCKETS 10
+
+/* bucket i counts launches that took less than (32 << i) ms, the last one collects the rest */
+struct ptychite_launch_stats {
+	struct wl_list link;
+	char *app_id;
+	uint32_t count;
+	double total_ms;
+	double max_ms;
+	uint32_t buckets[PTYCHITE_LAUNCH_HISTOGRAM_BUCKETS];
+};
 
 enum ptychite_cursor_mode {
 	PTYCHITE_CURSOR_PASSTHROUGH,
@@ -62,28 +75,58 @@ struct ptychite_server {
 	struct wlr_seat *seat;
 	struct wl_listener new_input;
 	struct wl_listener request_cursor;
+	const char *cursor_image;
+	bool pending_window_motion;
+	uint32_t pending_window_motion_time;
 	struct wl_listener request_set_selection;
 	struct wl_list keyboards;
+	struct ptychite_recorder *recorder;
+	struct ptychite_replay *replay;
+	struct xkb_context *xkb_context;
+	struct wl_list keymaps;
 	enum ptychite_cursor_mode cursor_mode;
 	struct ptychite_view *grabbed_view;
 	struct ptychite_window *hovered_window;
 	double grab_x, grab_y;
 	struct wl_array keys;
+	const struct ptychite_chord_trie_node *chord_cursor;
+	uint32_t chord_generation;
 
 	struct wlr_output_layout *output_layout;
 	struct wl_list monitors;
 	struct ptychite_monitor *active_monitor;
 	struct wl_listener new_output;
 	struct wl_listener layout_change;
+	struct wl_event_source *update_monitors_idle;
+
+	struct wl_event_source *output_profile_idle;
 
 	struct wlr_output_manager_v1 *output_mgr;
 	struct wl_listener output_mgr_apply;
 	struct wl_listener output_mgr_test;
 
-	/* struct wlr_idle *idle; */
-	/* struct wlr_idle_notifier_v1 *idle_notifier; */
-	/* struct wlr_idle_inhibit_manager_v1 *idle_inhibit_mgr; */
-	/* struct wl_listener idle_inhibitor_create; */
+	struct wlr_output_power_manager_v1 *output_power_mgr;
+	struct wl_listener output_power_set_mode;
+
+	struct wlr_idle_notifier_v1 *idle_notifier;
+	struct wlr_idle_inhibit_manager_v1 *idle_inhibit_mgr;
+	struct wl_listener idle_inhibitor_create;
+	struct wl_list idle_inhibitors;
+	struct wl_event_source *dpms_timer;
+	struct timespec last_activity;
+	bool outputs_off;
+
+	struct wl_list children;
+	struct wl_event_source *sigchld;
+
+	struct wlr_xdg_activation_v1 *xdg_activation;
+	struct wl_listener xdg_activation_request;
+	struct wl_list launches;
+	struct wl_list launch_stats;
+
+	struct wl_event_source *idle_flush;
+	bool needs_cursor_check;
+	bool needs_suspend_check;
 
 	struct wl_event_source *time_tick;
 	size_t seconds;
@@ -116,17 +159,32 @@ struct ptychite_server {
 	struct ptychite_hash_map icons;
 
 	struct ptychite_switcher switcher;
+
+	struct wl_list windows;
+	struct ptychite_hud hud;
 };
 
 struct ptychite_server *ptychite_server_create(void);
 int ptychite_server_init_and_run(struct ptychite_server *server, struct ptychite_compositor *compositor);
 void ptychite_server_configure_keyboards(struct ptychite_server *server);
+void ptychite_server_switch_keyboard_layout(struct ptychite_server *server, int delta);
 void ptychite_server_configure_panels(struct ptychite_server *server);
 void ptychite_server_configure_views(struct ptychite_server *server);
 void ptychite_server_refresh_wallpapers(struct ptychite_server *server);
 void ptychite_server_retile(struct ptychite_server *server);
+void ptychite_server_queue_output_profile(struct ptychite_server *server);
+void ptychite_server_update_power(struct ptychite_server *server);
+void ptychite_server_notify_activity(struct ptychite_server *server);
+void ptychite_server_configure_idle(struct ptychite_server *server);
+void ptychite_server_invalidate_hit_grids(struct ptychite_server *server);
 void ptychite_server_check_cursor(struct ptychite_server *server);
+void ptychite_server_check_suspended(struct ptychite_server *server);
+void ptychite_server_set_cursor_image(struct ptychite_server *server, const char *name);
+void ptychite_server_flush_cursor_motion(struct ptychite_server *server);
+void ptychite_server_schedule_flush(struct ptychite_server *server);
 void ptychite_server_execute_action(struct ptychite_server *server, struct ptychite_action *action);
+void ptychite_server_spawn(struct ptychite_server *server, char **args);
+void ptychite_server_match_launch(struct ptychite_server *server, struct ptychite_view *view);
 
 struct ptychite_view *ptychite_server_get_top_view(struct ptychite_server *server);
 struct ptychite_view *ptychite_server_get_front_view(struct ptychite_server *server);
@@ -1,10 +1,14 @@
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <errno.h>
+#include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
+#include <sys/syscall.h>
 
 #include "util.h"
 #include "macros.h"
@@ -49,13 +53,48 @@ bool ptychite_mouse_region_update_state(struct ptychite_mouse_region *region, do
 	return false;
 }
 
-void ptychite_spawn(char **args) {
-	if (!fork()) {
-		dup2(STDERR_FILENO, STDOUT_FILENO);
-		setsid();
-		execvp(args[0], args);
-		exit(EXIT_SUCCESS);
+extern char **environ;
+
+pid_t ptychite_spawn(char **args, char **env) {
+	posix_spawn_file_actions_t file_actions;
+	if (posix_spawn_file_actions_init(&file_actions)) {
+		return -1;
+	}
+	posix_spawn_file_actions_adddup2(&file_actions, STDERR_FILENO, STDOUT_FILENO);
+
+	posix_spawnattr_t attr;
+	if (posix_spawnattr_init(&attr)) {
+		posix_spawn_file_actions_destroy(&file_actions);
+		return -1;
 	}
+
+	sigset_t mask;
+	sigemptyset(&mask);
+	posix_spawnattr_setsigmask(&attr, &mask);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGMASK);
+
+	/* glibc implements this with clone(CLONE_VM | CLONE_VFORK), so no page tables are copied */
+	pid_t pid;
+	int err = posix_spawnp(&pid, args[0], &file_actions, &attr, args, env ? env : environ);
+
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&file_actions);
+
+	if (err) {
+		errno = err;
+		return -1;
+	}
+
+	return pid;
+}
+
+int ptychite_pidfd_open(pid_t pid) {
+#ifdef SYS_pidfd_open
+	return syscall(SYS_pidfd_open, pid, 0);
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
 }
 
 char *ptychite_get_command_output(const char *cmd) {
@@ -83,6 +122,59 @@ char *ptychite_get_command_output(const char *cmd) {
 	return strdup(buf);
 }
 
+double ptychite_timespec_diff_ms(const struct timespec *start, const struct timespec *end) {
+	return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static int uint32_compare(const void *data1, const void *data2) {
+	uint32_t value1 = *(const uint32_t *)data1;
+	uint32_t value2 = *(const uint32_t *)data2;
+
+	return (value1 > value2) - (value1 < value2);
+}
+
+void ptychite_sort_uint32(uint32_t *values, size_t len) {
+	qsort(values, len, sizeof(uint32_t), uint32_compare);
+}
+
+uint32_t ptychite_nearest_rank(const uint32_t *sorted, size_t len, int percentile) {
+	if (!len) {
+		return 0;
+	}
+
+	size_t rank = (len * percentile + 99) / 100;
+	return sorted[rank ? rank - 1 : 0];
+}
+
+void ptychite_samples_init(struct ptychite_samples *samples, size_t capacity) {
+	samples->capacity = capacity < PTYCHITE_SAMPLES_MAX ? capacity : PTYCHITE_SAMPLES_MAX;
+	samples->len = samples->next = 0;
+}
+
+void ptychite_samples_push(struct ptychite_samples *samples, uint32_t value) {
+	if (!samples->capacity) {
+		return;
+	}
+
+	samples->values[samples->next] = value;
+	samples->next = (samples->next + 1) % samples->capacity;
+	if (samples->len < samples->capacity) {
+		samples->len++;
+	}
+}
+
+void ptychite_samples_push_ms(struct ptychite_samples *samples, double ms) {
+	double us = ms * 1000;
+	ptychite_samples_push(samples, us < 0 ? 0 : us > UINT32_MAX ? UINT32_MAX : us);
+}
+
+size_t ptychite_samples_sort(const struct ptychite_samples *samples, uint32_t *sorted) {
+	memcpy(sorted, samples->values, samples->len * sizeof(uint32_t));
+	ptychite_sort_uint32(sorted, samples->len);
+
+	return samples->len;
+}
+
 /* HASH MAP IMPL */
 #define HASH_SEED 80085
 
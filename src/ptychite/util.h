@@ -1,6 +1,9 @@
 #ifndef PTYCHITE_UTIL_H
 #define PTYCHITE_UTIL_H
 
+#include <sys/types.h>
+#include <time.h>
+
 #include <wlr/util/box.h>
 
 char *ptychite_asprintf(const char *fmt, ...);
@@ -12,8 +15,25 @@ struct ptychite_mouse_region {
 
 bool ptychite_mouse_region_update_state(struct ptychite_mouse_region *region, double x, double y);
 
-void ptychite_spawn(char **args);
+pid_t ptychite_spawn(char **args, char **env);
+int ptychite_pidfd_open(pid_t pid);
 char *ptychite_get_command_output(const char *cmd);
+double ptychite_timespec_diff_ms(const struct timespec *start, const struct timespec *end);
+void ptychite_sort_uint32(uint32_t *values, size_t len);
+uint32_t ptychite_nearest_rank(const uint32_t *sorted, size_t len, int percentile);
+
+#define PTYCHITE_SAMPLES_MAX 512
+
+/* the most recent measurements of something, usually in microseconds */
+struct ptychite_samples {
+	uint32_t values[PTYCHITE_SAMPLES_MAX];
+	size_t capacity, len, next;
+};
+
+void ptychite_samples_init(struct ptychite_samples *samples, size_t capacity);
+void ptychite_samples_push(struct ptychite_samples *samples, uint32_t value);
+void ptychite_samples_push_ms(struct ptychite_samples *samples, double ms);
+size_t ptychite_samples_sort(const struct ptychite_samples *samples, uint32_t *sorted);
 
 
 
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <math.h>
 #include <wayland-util.h>
 
 #include <wlr/types/wlr_cursor.h>
@@ -20,23 +21,18 @@ struct ptychite_view *ptychite_element_get_view(struct ptychite_element *element
 	return view;
 }
 
-void ptychite_view_resize(struct ptychite_view *view, int width, int height) {
-	view->element.width = width;
-	view->element.height = height;
-
-	int border_thickness = view->server->compositor->config->views.border.thickness;
-	int top_thickness;
+static int view_get_top_thickness(struct ptychite_view *view) {
 	if (view->title_bar && view->title_bar->base.element.scene_tree->node.enabled) {
 		struct ptychite_font *font = &view->server->compositor->config->panel.font;
-		top_thickness = font->height + font->height / 6;
-	} else {
-		top_thickness = border_thickness;
+		return font->height + font->height / 6;
 	}
 
-	if (view->xdg_toplevel->base->client->shell->version >= XDG_TOPLEVEL_CONFIGURE_BOUNDS_SINCE_VERSION &&
-			view->element.width >= 0 && view->element.height >= 0) {
-		wlr_xdg_toplevel_set_bounds(view->xdg_toplevel, view->element.width, view->element.height);
-	}
+	return view->server->compositor->config->views.border.thickness;
+}
+
+void ptychite_view_clamp_size(struct ptychite_view *view, int *width, int *height) {
+	int border_thickness = view->server->compositor->config->views.border.thickness;
+	int top_thickness = view_get_top_thickness(view);
 
 	struct wlr_xdg_toplevel_state *state = &view->xdg_toplevel->current;
 	int max_width = state->max_width;
@@ -44,15 +40,107 @@ void ptychite_view_resize(struct ptychite_view *view, int width, int height) {
 	int min_width = state->min_width;
 	int min_height = state->min_height;
 
-	view->element.width = fmax(min_width + (2 * border_thickness), view->element.width);
-	view->element.height = fmax(min_height + (top_thickness + border_thickness), view->element.height);
+	*width = fmax(min_width + (2 * border_thickness), *width);
+	*height = fmax(min_height + (top_thickness + border_thickness), *height);
 
 	if (max_width > 0 && !(2 * border_thickness > INT_MAX - max_width)) {
-		view->element.width = fmin(max_width + (2 * border_thickness), view->element.width);
+		*width = fmin(max_width + (2 * border_thickness), *width);
 	}
 	if (max_height > 0 && !(top_thickness + border_thickness > INT_MAX - max_height)) {
-		view->element.height = fmin(max_height + (top_thickness + border_thickness), view->element.height);
+		*height = fmin(max_height + (top_thickness + border_thickness), *height);
+	}
+}
+
+static void view_snapshot_tree(
+		struct wlr_scene_tree *snapshot, struct wlr_scene_tree *tree, int x, int y, double scale_x, double scale_y) {
+	struct wlr_scene_node *node;
+	wl_list_for_each(node, &tree->children, link) {
+		if (!node->enabled) {
+			continue;
+		}
+
+		int node_x = x + node->x;
+		int node_y = y + node->y;
+		if (node->type == WLR_SCENE_NODE_TREE) {
+			view_snapshot_tree(snapshot, wlr_scene_tree_from_node(node), node_x, node_y, scale_x, scale_y);
+			continue;
+		} else if (node->type != WLR_SCENE_NODE_BUFFER) {
+			continue;
+		}
+
+		struct wlr_scene_buffer *scene_buffer = wlr_scene_buffer_from_node(node);
+		if (!scene_buffer->buffer) {
+			continue;
+		}
+
+		struct wlr_scene_buffer *clone = wlr_scene_buffer_create(snapshot, scene_buffer->buffer);
+		if (!clone) {
+			continue;
+		}
+
+		int width = scene_buffer->dst_width ? scene_buffer->dst_width : scene_buffer->buffer->width;
+		int height = scene_buffer->dst_height ? scene_buffer->dst_height : scene_buffer->buffer->height;
+		wlr_scene_node_set_position(&clone->node, round(node_x * scale_x), round(node_y * scale_y));
+		wlr_scene_buffer_set_dest_size(clone, round(width * scale_x), round(height * scale_y));
+		wlr_scene_buffer_set_source_box(clone, &scene_buffer->src_box);
+		wlr_scene_buffer_set_transform(clone, scene_buffer->transform);
+		wlr_scene_buffer_set_opacity(clone, scene_buffer->opacity);
+	}
+}
+
+static void view_drop_snapshot(struct ptychite_view *view) {
+	if (!view->snapshot) {
+		return;
+	}
+
+	wlr_scene_node_destroy(&view->snapshot->node);
+	view->snapshot = NULL;
+	wlr_scene_node_set_enabled(&view->scene_tree_surface->node, true);
+}
+
+/* the surface tree is left untouched until the client commits at the new size, so the snapshot is always rebuilt
+ * from it and scaled from the size the client last drew at */
+static bool view_take_snapshot(struct ptychite_view *view, int width, int height) {
+	struct wlr_box *geometry = &view->xdg_toplevel->base->current.geometry;
+	if (geometry->width <= 0 || geometry->height <= 0) {
+		return false;
+	}
+
+	struct wlr_scene_tree *snapshot = wlr_scene_tree_create(view->element.scene_tree);
+	if (!snapshot) {
+		return false;
 	}
+	wlr_scene_node_set_position(&snapshot->node, view->scene_tree_surface->node.x, view->scene_tree_surface->node.y);
+	view_snapshot_tree(snapshot, view->scene_tree_surface, 0, 0, (double)width / geometry->width,
+			(double)height / geometry->height);
+
+	if (wl_list_empty(&snapshot->children)) {
+		wlr_scene_node_destroy(&snapshot->node);
+		return false;
+	}
+
+	if (view->snapshot) {
+		wlr_scene_node_destroy(&view->snapshot->node);
+	}
+	view->snapshot = snapshot;
+	wlr_scene_node_set_enabled(&view->scene_tree_surface->node, false);
+
+	return true;
+}
+
+void ptychite_view_resize(struct ptychite_view *view, int width, int height) {
+	int border_thickness = view->server->compositor->config->views.border.thickness;
+	int top_thickness = view_get_top_thickness(view);
+
+	if (view->xdg_toplevel->base->client->shell->version >= XDG_TOPLEVEL_CONFIGURE_BOUNDS_SINCE_VERSION &&
+			width >= 0 && height >= 0) {
+		wlr_xdg_toplevel_set_bounds(view->xdg_toplevel, width, height);
+	}
+
+	ptychite_view_clamp_size(view, &width, &height);
+	view->element.width = width;
+	view->element.height = height;
+	ptychite_server_invalidate_hit_grids(view->server);
 
 	if (view->title_bar && view->title_bar->base.element.scene_tree->node.enabled &&
 			(view->title_bar->base.element.width != view->element.width ||
@@ -65,9 +153,24 @@ void ptychite_view_resize(struct ptychite_view *view, int width, int height) {
 		ptychite_window_relay_draw(&view->title_bar->base, view->element.width, top_thickness);
 	}
 
+	int surface_width = view->element.width - 2 * border_thickness;
+	int surface_height = view->element.height - (top_thickness + border_thickness);
 	wlr_scene_node_set_position(&view->scene_tree_surface->node, border_thickness, top_thickness);
-	view->resize_serial = wlr_xdg_toplevel_set_size(view->xdg_toplevel, view->element.width - 2 * border_thickness,
-			view->element.height - (top_thickness + border_thickness));
+	view->resize_serial = wlr_xdg_toplevel_set_size(view->xdg_toplevel, surface_width, surface_height);
+	if (view->monitor && view != view->server->grabbed_view && view->element.scene_tree->node.enabled) {
+		/* a scaled snapshot stands in for the client until it catches up, so only views without one need to
+		 * hold back the output */
+		if (view_take_snapshot(view, surface_width, surface_height)) {
+			view->snapshot_serial = view->resize_serial;
+			wl_list_remove(&view->pending_resize_link);
+			wl_list_init(&view->pending_resize_link);
+		} else {
+			if (wl_list_empty(&view->pending_resize_link)) {
+				wl_list_insert(&view->monitor->pending_resizes, &view->pending_resize_link);
+			}
+			ptychite_monitor_begin_transaction(view->monitor);
+		}
+	}
 
 	if (view->border.top->node.enabled) {
 		wlr_scene_rect_set_size(view->border.top, view->element.width, border_thickness);
@@ -82,6 +185,35 @@ void ptychite_view_resize(struct ptychite_view *view, int width, int height) {
 			view->border.left, border_thickness, view->element.height - (top_thickness + border_thickness));
 }
 
+void ptychite_view_clear_pending_resize(struct ptychite_view *view) {
+	view->resize_serial = 0;
+	wl_list_remove(&view->pending_resize_link);
+	wl_list_init(&view->pending_resize_link);
+}
+
+void ptychite_view_interactive_resize(struct ptychite_view *view, int width, int height) {
+	/* pointer motion is far faster than clients can render, so the client only ever has one configure in flight
+	 * and the newest size waits for its ack */
+	if (view->resize_serial) {
+		view->interactive_resize.pending = true;
+		view->interactive_resize.width = width;
+		view->interactive_resize.height = height;
+		return;
+	}
+
+	view->interactive_resize.pending = false;
+	ptychite_view_resize(view, width, height);
+}
+
+void ptychite_view_flush_interactive_resize(struct ptychite_view *view) {
+	if (!view->interactive_resize.pending) {
+		return;
+	}
+
+	view->interactive_resize.pending = false;
+	ptychite_view_resize(view, view->interactive_resize.width, view->interactive_resize.height);
+}
+
 void ptychite_surface_unfocus(struct wlr_surface *surface) {
 	struct wlr_xdg_surface *xdg_surface = wlr_xdg_surface_try_from_wlr_surface(surface);
 	assert(xdg_surface && xdg_surface->role == WLR_XDG_SURFACE_ROLE_TOPLEVEL);
@@ -118,6 +250,11 @@ void ptychite_view_focus(struct ptychite_view *view, struct wlr_surface *surface
 
 	view->focused = true;
 	wlr_scene_node_raise_to_top(&view->element.scene_tree->node);
+	ptychite_server_invalidate_hit_grids(server);
+	ptychite_server_check_suspended(server);
+	if (view->monitor) {
+		ptychite_monitor_note_input_response(view->monitor);
+	}
 	wl_list_remove(&view->server_link);
 	wl_list_insert(&server->views, &view->server_link);
 	if (view->workspace) {
@@ -142,6 +279,8 @@ void ptychite_view_focus(struct ptychite_view *view, struct wlr_surface *surface
 
 	if (view->monitor && view->workspace != view->monitor->current_workspace) {
 		ptychite_monitor_switch_workspace(view->monitor, view->workspace);
+	} else if (view->monitor && config->tiling.mode == PTYCHITE_TILING_SCROLLABLE) {
+		ptychite_monitor_tile(view->monitor);
 	}
 
 	server->active_monitor = view->monitor;
@@ -165,24 +304,48 @@ void ptychite_view_begin_interactive(struct ptychite_view *view, enum ptychite_c
 	server->grabbed_view = view;
 	server->cursor_mode = mode;
 
+	/* views sit in their monitor's tree, which is moved by the scroll offset, so the grab is kept in layout
+	 * coordinates */
+	int lx, ly;
+	wlr_scene_node_coords(&view->element.scene_tree->node, &lx, &ly);
 	if (mode == PTYCHITE_CURSOR_MOVE) {
-		server->grab_x = server->cursor->x - view->element.scene_tree->node.x;
-		server->grab_y = server->cursor->y - view->element.scene_tree->node.y;
-		wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "fleur");
+		server->grab_x = server->cursor->x - lx;
+		server->grab_y = server->cursor->y - ly;
+		ptychite_server_set_cursor_image(server, "fleur");
 	} else {
-		double border_x = view->element.scene_tree->node.x + view->element.width;
-		double border_y = view->element.scene_tree->node.y + view->element.height;
+		double border_x = lx + view->element.width;
+		double border_y = ly + view->element.height;
 		server->grab_x = server->cursor->x - border_x;
 		server->grab_y = server->cursor->y - border_y;
-		wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "bottom_right_corner");
+		ptychite_server_set_cursor_image(server, "bottom_right_corner");
 	}
 }
 
 static void view_handle_commit(struct wl_listener *listener, void *data) {
 	struct ptychite_view *view = wl_container_of(listener, view, commit);
 
-	if (view->resize_serial && view->resize_serial <= view->xdg_toplevel->base->current.configure_serial) {
-		view->resize_serial = 0;
+	uint32_t configure_serial = view->xdg_toplevel->base->current.configure_serial;
+	if (view->resize_serial && view->resize_serial <= configure_serial) {
+		ptychite_view_clear_pending_resize(view);
+		ptychite_view_flush_interactive_resize(view);
+	}
+	if (view->snapshot && view->snapshot_serial <= configure_serial) {
+		view_drop_snapshot(view);
+	}
+
+	/* input goes to the focused views, so their commits are what the input latency is measured against */
+	struct wlr_surface *surface = view->xdg_toplevel->base->surface;
+	struct wlr_surface *pointer_surface = view->server->seat->pointer_state.focused_surface;
+	bool pointer_focused = pointer_surface && wlr_surface_get_root_surface(pointer_surface) == surface;
+	if (view->monitor && (view->focused || pointer_focused)) {
+		ptychite_monitor_note_input_response(view->monitor);
+	}
+
+	/* clients can draw at a size other than the one they were configured to, which moves the view's bounds */
+	if (surface->current.width != view->committed_width || surface->current.height != view->committed_height) {
+		view->committed_width = surface->current.width;
+		view->committed_height = surface->current.height;
+		ptychite_server_invalidate_hit_grids(view->server);
 	}
 }
 
@@ -194,14 +357,70 @@ static void view_handle_set_title(struct wl_listener *listener, void *data) {
 	}
 }
 
+static void view_handle_set_app_id(struct wl_listener *listener, void *data) {
+	struct ptychite_view *view = wl_container_of(listener, view, set_app_id);
+
+	ptychite_view_resolve_application(view);
+}
+
+/* the scene enters and leaves outputs as the visible region of a buffer changes, so this also follows other clients
+ * covering or uncovering the view on their own commits */
+static void view_handle_surface_output_enter(struct wl_listener *listener, void *data) {
+	struct ptychite_view *view = wl_container_of(listener, view, surface_output_enter);
+
+	ptychite_server_check_suspended(view->server);
+}
+
+static void view_handle_surface_output_leave(struct wl_listener *listener, void *data) {
+	struct ptychite_view *view = wl_container_of(listener, view, surface_output_leave);
+
+	ptychite_server_check_suspended(view->server);
+}
+
+/* the scene buffer goes with the surface, which can be destroyed before the view is */
+static void view_handle_surface_buffer_destroy(struct wl_listener *listener, void *data) {
+	struct ptychite_view *view = wl_container_of(listener, view, surface_buffer_destroy);
+
+	wl_list_remove(&view->surface_output_enter.link);
+	wl_list_remove(&view->surface_output_leave.link);
+	wl_list_remove(&view->surface_buffer_destroy.link);
+	view->surface_buffer = NULL;
+}
+
+static void view_find_surface_buffer_iterator(struct wlr_scene_buffer *buffer, int sx, int sy, void *data) {
+	struct ptychite_view *view = data;
+
+	struct wlr_scene_surface *scene_surface = wlr_scene_surface_try_from_buffer(buffer);
+	if (scene_surface && scene_surface->surface == view->xdg_toplevel->base->surface) {
+		view->surface_buffer = buffer;
+	}
+}
+
 static void view_handle_map(struct wl_listener *listener, void *data) {
 	struct ptychite_view *view = wl_container_of(listener, view, map);
 	struct ptychite_config *config = view->server->compositor->config;
 
+	ptychite_server_match_launch(view->server, view);
+	/* applications are only refreshed for mapped views, so whatever was cached before may have been freed since */
+	ptychite_view_resolve_application(view);
+
+	if (!view->surface_buffer) {
+		wlr_scene_node_for_each_buffer(&view->scene_tree_surface->node, view_find_surface_buffer_iterator, view);
+		if (view->surface_buffer) {
+			view->surface_output_enter.notify = view_handle_surface_output_enter;
+			wl_signal_add(&view->surface_buffer->events.output_enter, &view->surface_output_enter);
+			view->surface_output_leave.notify = view_handle_surface_output_leave;
+			wl_signal_add(&view->surface_buffer->events.output_leave, &view->surface_output_leave);
+			view->surface_buffer_destroy.notify = view_handle_surface_buffer_destroy;
+			wl_signal_add(&view->surface_buffer->node.events.destroy, &view->surface_buffer_destroy);
+		}
+	}
+
 	wl_list_insert(&view->server->views, &view->server_link);
 	if (view->server->active_monitor) {
 		view->monitor = view->server->active_monitor;
 		view->workspace = view->monitor->current_workspace;
+		wlr_scene_node_reparent(&view->element.scene_tree->node, view->monitor->scene_tree);
 
 		wl_list_insert(&view->monitor->views, &view->monitor_link);
 		wl_list_insert(config->views.map_to_front ? &view->workspace->views_order : view->workspace->views_order.prev,
@@ -240,6 +459,7 @@ static void view_handle_map(struct wl_listener *listener, void *data) {
 	}
 
 	wlr_scene_node_set_enabled(&view->element.scene_tree->node, true);
+	ptychite_server_invalidate_hit_grids(view->server);
 	ptychite_view_focus(view, view->xdg_toplevel->base->surface);
 }
 
@@ -250,6 +470,7 @@ static void view_handle_unmap(struct wl_listener *listener, void *data) {
 		view->server->cursor_mode = PTYCHITE_CURSOR_PASSTHROUGH;
 		view->server->grabbed_view = NULL;
 	}
+	view->interactive_resize.pending = false;
 
 	wl_list_remove(&view->workspace_order_link);
 	wl_list_remove(&view->workspace_focus_link);
@@ -261,6 +482,13 @@ static void view_handle_unmap(struct wl_listener *listener, void *data) {
 	wl_list_remove(&view->set_title.link);
 
 	wlr_scene_node_set_enabled(&view->element.scene_tree->node, false);
+	ptychite_server_invalidate_hit_grids(view->server);
+	view->offscreen = false;
+	view->suspended = false;
+	view->application = NULL;
+	view->icon = NULL;
+	ptychite_view_clear_pending_resize(view);
+	view_drop_snapshot(view);
 
 	if (view->monitor) {
 		ptychite_monitor_tile(view->monitor);
@@ -288,8 +516,11 @@ static void view_handle_destroy(struct wl_listener *listener, void *data) {
 	wl_list_remove(&view->destroy.link);
 	wl_list_remove(&view->request_maximize.link);
 	wl_list_remove(&view->request_fullscreen.link);
+	wl_list_remove(&view->set_app_id.link);
+	wl_list_remove(&view->pending_resize_link);
 
 	wlr_scene_node_destroy(&view->element.scene_tree->node);
+	ptychite_server_invalidate_hit_grids(view->server);
 
 	free(view);
 }
@@ -306,7 +537,37 @@ static void view_handle_request_fullscreen(struct wl_listener *listener, void *d
 	wlr_xdg_surface_schedule_configure(view->xdg_toplevel->base);
 }
 
+static void view_buffer_visible_iterator(struct wlr_scene_buffer *buffer, int sx, int sy, void *data) {
+	bool *visible = data;
+
+	if (buffer->primary_output) {
+		*visible = true;
+	}
+}
+
+/* the scene only gives a buffer a primary output while part of its visible region lands on one, so views on hidden
+ * workspaces, scrolled offscreen, or fully covered by opaque content have none and can stop drawing */
+void ptychite_view_update_suspended(struct ptychite_view *view) {
+	bool visible = false;
+	int x, y;
+	if (wlr_scene_node_coords(&view->element.scene_tree->node, &x, &y)) {
+		wlr_scene_node_for_each_buffer(&view->scene_tree_surface->node, view_buffer_visible_iterator, &visible);
+		if (view->snapshot) {
+			wlr_scene_node_for_each_buffer(&view->snapshot->node, view_buffer_visible_iterator, &visible);
+		}
+	}
+
+	if (view->suspended == !visible) {
+		return;
+	}
+
+	view->suspended = !visible;
+	wlr_xdg_toplevel_set_suspended(view->xdg_toplevel, view->suspended);
+}
+
 void ptychite_view_rig(struct ptychite_view *view, struct wlr_xdg_surface *xdg_surface) {
+	wl_list_init(&view->pending_resize_link);
+
 	view->map.notify = view_handle_map;
 	wl_signal_add(&xdg_surface->surface->events.map, &view->map);
 	view->unmap.notify = view_handle_unmap;
@@ -319,14 +580,32 @@ void ptychite_view_rig(struct ptychite_view *view, struct wlr_xdg_surface *xdg_s
 	wl_signal_add(&toplevel->events.request_maximize, &view->request_maximize);
 	view->request_fullscreen.notify = view_handle_request_fullscreen;
 	wl_signal_add(&toplevel->events.request_fullscreen, &view->request_fullscreen);
+	view->set_app_id.notify = view_handle_set_app_id;
+	wl_signal_add(&toplevel->events.set_app_id, &view->set_app_id);
+
+	ptychite_view_resolve_application(view);
 }
 
-struct ptychite_icon *ptychite_view_get_icon(struct ptychite_view *view) {
-	struct ptychite_application *application =
-			ptychite_hash_map_get(&view->server->applications, view->xdg_toplevel->app_id);
-	if (!application) {
-		return NULL;
+void ptychite_view_resolve_application(struct ptychite_view *view) {
+	struct ptychite_server *server = view->server;
+	struct ptychite_icon *old_icon = view->icon;
+
+	view->application = ptychite_server_lookup_application(server, view->xdg_toplevel->app_id);
+	view->icon = view->application && view->application->resolved_icon
+			? ptychite_hash_map_get(&server->icons, view->application->resolved_icon)
+			: NULL;
+
+	if (view->focused && view->icon != old_icon) {
+		struct ptychite_monitor *monitor;
+		wl_list_for_each(monitor, &server->monitors, link) {
+			if (!monitor->panel || !monitor->panel->base.element.scene_tree->node.enabled) {
+				continue;
+			}
+			ptychite_window_relay_draw_same_size(&monitor->panel->base);
+		}
 	}
+}
 
-	return ptychite_hash_map_get(&view->server->icons, application->resolved_icon);
+struct ptychite_icon *ptychite_view_get_icon(struct ptychite_view *view) {
+	return view->icon;
 }
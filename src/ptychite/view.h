@@ -1,9 +1,12 @@
 #ifndef PTYCHITE_VIEW_H
 #define PTYCHITE_VIEW_H
 
+#include <time.h>
+
 #include "element.h"
 #include "server.h"
 
+struct ptychite_application;
 struct ptychite_icon;
 
 struct ptychite_view {
@@ -22,6 +25,9 @@ struct ptychite_view {
 	struct ptychite_workspace *workspace;
 	struct wlr_xdg_toplevel *xdg_toplevel;
 	struct wlr_scene_tree *scene_tree_surface;
+	struct wlr_scene_buffer *surface_buffer;
+	struct wlr_scene_tree *snapshot;
+	uint32_t snapshot_serial;
 	struct ptychite_title_bar *title_bar;
 	struct {
 		struct wlr_scene_rect *top;
@@ -30,10 +36,26 @@ struct ptychite_view {
 		struct wlr_scene_rect *left;
 	} border;
 
+	struct ptychite_application *application;
+	struct ptychite_icon *icon;
+
 	int initial_width;
 	int initial_height;
+	int committed_width;
+	int committed_height;
 	uint32_t resize_serial;
+	struct wl_list pending_resize_link;
+	struct {
+		bool pending;
+		int width, height;
+	} interactive_resize;
 	bool focused;
+	bool offscreen;
+	bool suspended;
+
+	struct timespec map_time;
+	struct timespec launch_start;
+	bool launch_pending;
 
 	struct wl_listener map;
 	struct wl_listener unmap;
@@ -42,16 +64,26 @@ struct ptychite_view {
 	struct wl_listener request_maximize;
 	struct wl_listener request_fullscreen;
 	struct wl_listener set_title;
+	struct wl_listener set_app_id;
+	struct wl_listener surface_output_enter;
+	struct wl_listener surface_output_leave;
+	struct wl_listener surface_buffer_destroy;
 };
 
 struct ptychite_view *ptychite_element_get_view(struct ptychite_element *element);
 
+void ptychite_view_clamp_size(struct ptychite_view *view, int *width, int *height);
 void ptychite_view_resize(struct ptychite_view *view, int width, int height);
+void ptychite_view_clear_pending_resize(struct ptychite_view *view);
+void ptychite_view_interactive_resize(struct ptychite_view *view, int width, int height);
+void ptychite_view_flush_interactive_resize(struct ptychite_view *view);
 void ptychite_surface_unfocus(struct wlr_surface *surface);
 void ptychite_view_focus(struct ptychite_view *view, struct wlr_surface *surface);
 void ptychite_view_begin_interactive(struct ptychite_view *view, enum ptychite_cursor_mode mode);
+void ptychite_view_update_suspended(struct ptychite_view *view);
 void ptychite_view_rig(struct ptychite_view *view, struct wlr_xdg_surface *xdg_surface);
 
+void ptychite_view_resolve_application(struct ptychite_view *view);
 struct ptychite_icon *ptychite_view_get_icon(struct ptychite_view *view);
 
 #endif
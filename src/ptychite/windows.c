@@ -5,6 +5,7 @@
 #include <wlr/types/wlr_scene.h>
 
 #include "buffer.h"
+#include "monitor.h"
 #include "server.h"
 #include "windows.h"
 
@@ -69,9 +70,13 @@ static int window_redraw_now(struct ptychite_window *window) {
 	buffer->surface = surface;
 	wlr_buffer_init(&buffer->base, &ptychite_buffer_buffer_impl, scaled_width, scaled_height);
 
+	if (window->scene_buffer->dst_width != width || window->scene_buffer->dst_height != height) {
+		ptychite_server_invalidate_hit_grids(window->server);
+	}
 	wlr_scene_buffer_set_dest_size(window->scene_buffer, width, height);
 	wlr_scene_buffer_set_buffer(window->scene_buffer, &buffer->base);
 	wlr_buffer_drop(&buffer->base);
+	window->redraws++;
 
 	return 0;
 
@@ -99,6 +104,7 @@ static void window_handle_destroy(struct wl_listener *listener, void *data) {
 	struct ptychite_window *window = wl_container_of(listener, window, destroy);
 
 	wl_list_remove(&window->destroy.link);
+	wl_list_remove(&window->link);
 
 	if (window->server->hovered_window == window) {
 		window->server->hovered_window = NULL;
@@ -128,6 +134,7 @@ int ptychite_window_init(struct ptychite_window *window, struct ptychite_server
 	window->impl = impl;
 	window->output = output;
 	window->immediate_redraw = true;
+	wl_list_insert(server->windows.prev, &window->link);
 
 	window->frame_done.notify = window_handle_frame_done;
 	wl_signal_add(&scene_buffer->events.frame_done, &window->frame_done);
@@ -157,12 +164,20 @@ void ptychite_window_relay_draw_same_size(struct ptychite_window *window) {
 	ptychite_window_relay_draw(window, window->element.width, window->element.height);
 }
 
+/* a redraw requested while a window handles pointer input is that input's response */
+static void window_note_input_response(struct ptychite_window *window) {
+	if (window->redraw && window->output && window->output->data) {
+		ptychite_monitor_note_input_response(window->output->data);
+	}
+}
+
 void ptychite_window_relay_pointer_enter(struct ptychite_window *window) {
 	if (!window->impl || !window->impl->handle_pointer_enter) {
 		return;
 	}
 
 	window->impl->handle_pointer_enter(window);
+	window_note_input_response(window);
 }
 
 void ptychite_window_relay_pointer_leave(struct ptychite_window *window) {
@@ -171,6 +186,7 @@ void ptychite_window_relay_pointer_leave(struct ptychite_window *window) {
 	}
 
 	window->impl->handle_pointer_leave(window);
+	window_note_input_response(window);
 }
 
 void ptychite_window_relay_pointer_move(struct ptychite_window *window, double x, double y) {
@@ -183,6 +199,7 @@ void ptychite_window_relay_pointer_move(struct ptychite_window *window, double x
 	double scale_y = scale * y;
 
 	window->impl->handle_pointer_move(window, scale_x, scale_y);
+	window_note_input_response(window);
 }
 
 void ptychite_window_relay_pointer_button(
@@ -196,4 +213,5 @@ void ptychite_window_relay_pointer_button(
 	double scale_y = scale * y;
 
 	window->impl->handle_pointer_button(window, scale_x, scale_y, event);
+	window_note_input_response(window);
 }
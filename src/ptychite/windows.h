@@ -2,6 +2,8 @@
 #define PTYCHITE_WINDOWS_H
 
 #include <cairo.h>
+#include <pixman.h>
+#include <time.h>
 #include <wayland-util.h>
 
 #include <wlr/types/wlr_pointer.h>
@@ -13,18 +15,22 @@
 
 struct ptychite_window {
 	struct ptychite_element element;
+	struct wl_list link; // ptychite_server::windows
 	struct ptychite_server *server;
 	struct wlr_output *output;
 	struct wlr_scene_buffer *scene_buffer;
 	const struct ptychite_window_impl *impl;
 	bool redraw;
 	bool immediate_redraw;
+	uint32_t redraws;
+	uint32_t last_redraws;
 
 	struct wl_listener frame_done;
 	struct wl_listener destroy;
 };
 
 struct ptychite_window_impl {
+	const char *name;
 	void (*draw)(struct ptychite_window *window, cairo_t *cairo, int surface_width, int surface_height, float scale);
 	void (*handle_pointer_move)(struct ptychite_window *window, double x, double y);
 	void (*handle_pointer_button)(
@@ -104,6 +110,7 @@ struct ptychite_switcher_app {
 	struct wl_list link;
 
 	struct ptychite_application *app;
+	struct ptychite_icon *icon;
 
 	struct wl_list views;
 	int idx;
@@ -123,6 +130,51 @@ extern const struct ptychite_window_impl ptychite_sub_switcher_window_impl;
 
 void ptychite_switcher_draw_auto(struct ptychite_switcher *switcher, bool sub_switcher);
 
+/* HUD */
+#define PTYCHITE_HUD_DAMAGE_BOXES 4
+#define PTYCHITE_HUD_KINDS 16
+
+struct ptychite_hud_kind {
+	const struct ptychite_window_impl *impl;
+	int windows;
+	uint32_t redraws;
+	double rate;
+};
+
+struct ptychite_hud {
+	struct ptychite_window base;
+
+	struct timespec last_sample;
+	struct ptychite_hud_kind kinds[PTYCHITE_HUD_KINDS];
+	int kinds_len;
+
+	struct {
+		bool flash;
+		struct ptychite_monitor *monitor;
+		struct wlr_scene_tree *tree;
+		struct wlr_buffer *tint;
+		struct wl_event_source *timer;
+		pixman_region32_t flashed;
+
+		uint32_t frames;
+		uint32_t last_frames;
+		double rate;
+		int rects;
+		double coverage;
+		struct wlr_box boxes[PTYCHITE_HUD_DAMAGE_BOXES];
+	} damage;
+};
+
+extern const struct ptychite_window_impl ptychite_hud_window_impl;
+
+int ptychite_hud_init(struct ptychite_hud *hud, struct ptychite_server *server);
+void ptychite_hud_finish(struct ptychite_hud *hud);
+void ptychite_hud_draw_auto(struct ptychite_hud *hud);
+void ptychite_hud_toggle(struct ptychite_hud *hud);
+void ptychite_hud_toggle_damage(struct ptychite_hud *hud);
+void ptychite_hud_capture_damage(struct ptychite_hud *hud, struct ptychite_monitor *monitor);
+void ptychite_hud_forget_monitor(struct ptychite_hud *hud, struct ptychite_monitor *monitor);
+
 /* Notification */
 struct ptychite_notification {
 	struct ptychite_window base;
@@ -217,6 +217,7 @@ static void control_destroy(struct ptychite_window *window) {
 }
 
 const struct ptychite_window_impl ptychite_control_window_impl = {
+		.name = "control",
 		.draw = control_draw,
 		.handle_pointer_enter = NULL,
 		.handle_pointer_leave = control_handle_pointer_leave,
@@ -253,6 +254,7 @@ void ptychite_control_show(struct ptychite_control *control) {
 
 	ptychite_control_draw_auto(control);
 	wlr_scene_node_set_enabled(&control->base.element.scene_tree->node, true);
+	ptychite_server_invalidate_hit_grids(control->base.server);
 
 	struct ptychite_monitor *monitor = control->base.server->active_monitor;
 	if (monitor && monitor->panel && monitor->panel->base.element.scene_tree->node.enabled) {
@@ -262,6 +264,7 @@ void ptychite_control_show(struct ptychite_control *control) {
 
 void ptychite_control_hide(struct ptychite_control *control) {
 	wlr_scene_node_set_enabled(&control->base.element.scene_tree->node, false);
+	ptychite_server_invalidate_hit_grids(control->base.server);
 
 	struct ptychite_monitor *monitor = control->base.server->active_monitor;
 	if (monitor && monitor->panel && monitor->panel->base.element.scene_tree->node.enabled) {
@@ -0,0 +1,388 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wayland-util.h>
+
+#include <wlr/types/wlr_output.h>
+#include <wlr/types/wlr_scene.h>
+#include <wlr/util/region.h>
+
+#include "../buffer.h"
+#include "../compositor.h"
+#include "../config.h"
+#include "../draw.h"
+#include "../monitor.h"
+#include "../server.h"
+#include "../util.h"
+#include "../windows.h"
+
+#define HUD_FLASH_MS 250
+#define HUD_LINE_SIZE 96
+#define HUD_FIXED_LINES (6 + PTYCHITE_HUD_DAMAGE_BOXES)
+#define HUD_LINES (HUD_FIXED_LINES + PTYCHITE_HUD_KINDS)
+
+static const float hud_damage_tint[4] = {1.0, 0.0, 0.5, 0.3};
+
+static double hud_percentile_ms(const struct ptychite_samples *samples, int percentile) {
+	uint32_t sorted[PTYCHITE_SAMPLES_MAX];
+	size_t len = ptychite_samples_sort(samples, sorted);
+
+	return len ? ptychite_nearest_rank(sorted, len, percentile) / 1000.0 : 0;
+}
+
+static int hud_format(struct ptychite_hud *hud, char lines[][HUD_LINE_SIZE]) {
+	struct ptychite_monitor *monitor = hud->base.server->active_monitor;
+	if (!monitor) {
+		return 0;
+	}
+
+	int len = 0;
+	snprintf(lines[len++], HUD_LINE_SIZE, "%s  %.2f Hz", monitor->output->name, monitor->output->refresh / 1000.0);
+	snprintf(lines[len++], HUD_LINE_SIZE, "frame     p50 %6.2f  p99 %6.2f ms",
+			hud_percentile_ms(&monitor->stats.frame_interval_us, 50),
+			hud_percentile_ms(&monitor->stats.frame_interval_us, 99));
+	snprintf(lines[len++], HUD_LINE_SIZE, "commit    p50 %6.2f  p99 %6.2f ms",
+			hud_percentile_ms(&monitor->stats.commit_us, 50), hud_percentile_ms(&monitor->stats.commit_us, 99));
+	snprintf(lines[len++], HUD_LINE_SIZE, "present   p99 %6.2f ms  %u missed",
+			hud_percentile_ms(&monitor->stats.present_us, 99), monitor->stats.missed);
+	snprintf(lines[len++], HUD_LINE_SIZE, "damage    %.0f/s  %d rects  %.1f%%%s", hud->damage.rate,
+			hud->damage.rects, hud->damage.coverage * 100, hud->damage.flash ? "  flashing" : "");
+
+	int i;
+	for (i = 0; i < PTYCHITE_HUD_DAMAGE_BOXES; i++) {
+		struct wlr_box *box = &hud->damage.boxes[i];
+		if (i < hud->damage.rects && !wlr_box_empty(box)) {
+			snprintf(lines[len++], HUD_LINE_SIZE, "  %dx%d+%d+%d", box->width, box->height, box->x, box->y);
+		} else {
+			*lines[len++] = '\0';
+		}
+	}
+
+	snprintf(lines[len++], HUD_LINE_SIZE, "redraws");
+	for (i = 0; i < hud->kinds_len; i++) {
+		struct ptychite_hud_kind *kind = &hud->kinds[i];
+		snprintf(lines[len++], HUD_LINE_SIZE, "  %-13s x%-3d %5.1f/s  %u", kind->impl->name ? kind->impl->name : "window",
+				kind->windows, kind->rate, kind->redraws);
+	}
+
+	return len;
+}
+
+static void hud_draw(struct ptychite_window *window, cairo_t *cairo, int surface_width, int surface_height, float scale) {
+	struct ptychite_hud *hud = wl_container_of(window, hud, base);
+	struct ptychite_config *config = hud->base.server->compositor->config;
+
+	float *background = config->panel.colors.background;
+	float *border = config->panel.colors.border;
+	float *foreground = config->panel.colors.foreground;
+	float *gray3 = config->panel.colors.gray3;
+	struct ptychite_font *font = &config->panel.font;
+
+	ptychite_cairo_draw_rounded_rect(cairo, 1, 1, surface_width - 2, surface_height - 2, 6 * scale);
+	cairo_set_source_rgba(cairo, background[0], background[1], background[2], background[3] * 0.85);
+	cairo_fill_preserve(cairo);
+	cairo_set_source_rgba(cairo, border[0], border[1], border[2], border[3]);
+	cairo_set_line_width(cairo, 2);
+	cairo_stroke(cairo);
+
+	char lines[HUD_LINES][HUD_LINE_SIZE];
+	int len = hud_format(hud, lines);
+
+	int y = 8 * scale;
+	int i;
+	for (i = 0; i < len; i++) {
+		cairo_move_to(cairo, 10 * scale, y);
+		int height;
+		if (!ptychite_cairo_draw_text(cairo, font->font, lines[i], i == 0 ? foreground : gray3, NULL, scale * 0.7,
+					false, NULL, &height)) {
+			y += height;
+		}
+	}
+}
+
+const struct ptychite_window_impl ptychite_hud_window_impl = {
+		.name = "hud",
+		.draw = hud_draw,
+		.handle_pointer_enter = NULL,
+		.handle_pointer_leave = NULL,
+		.handle_pointer_move = NULL,
+		.handle_pointer_button = NULL,
+		.destroy = NULL,
+};
+
+/* redraws are counted per window implementation, so that for example all title bars redrawing on a focus change show
+ * up as one line */
+static void hud_sample(struct ptychite_hud *hud) {
+	struct ptychite_server *server = hud->base.server;
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double elapsed = ptychite_timespec_diff_ms(&hud->last_sample, &now) / 1000.0;
+	hud->last_sample = now;
+	if (elapsed <= 0) {
+		elapsed = 1;
+	}
+
+	hud->kinds_len = 0;
+	struct ptychite_window *window;
+	wl_list_for_each(window, &server->windows, link) {
+		uint32_t delta = window->redraws - window->last_redraws;
+		window->last_redraws = window->redraws;
+
+		int i;
+		for (i = 0; i < hud->kinds_len; i++) {
+			if (hud->kinds[i].impl == window->impl) {
+				break;
+			}
+		}
+		if (i == hud->kinds_len) {
+			if (hud->kinds_len == PTYCHITE_HUD_KINDS) {
+				continue;
+			}
+			hud->kinds[hud->kinds_len++] = (struct ptychite_hud_kind){.impl = window->impl};
+		}
+
+		hud->kinds[i].windows++;
+		hud->kinds[i].redraws += window->redraws;
+		hud->kinds[i].rate += delta / elapsed;
+	}
+
+	int i, j;
+	for (i = 1; i < hud->kinds_len; i++) {
+		struct ptychite_hud_kind kind = hud->kinds[i];
+		for (j = i; j > 0 && hud->kinds[j - 1].rate < kind.rate; j--) {
+			hud->kinds[j] = hud->kinds[j - 1];
+		}
+		hud->kinds[j] = kind;
+	}
+
+	hud->damage.rate = (hud->damage.frames - hud->damage.last_frames) / elapsed;
+	hud->damage.last_frames = hud->damage.frames;
+}
+
+void ptychite_hud_draw_auto(struct ptychite_hud *hud) {
+	struct ptychite_monitor *monitor = hud->base.server->active_monitor;
+	if (!monitor) {
+		return;
+	}
+
+	hud_sample(hud);
+
+	struct ptychite_config *config = hud->base.server->compositor->config;
+	struct ptychite_font *font = &config->panel.font;
+
+	int margin = monitor->window_geometry.height / 60;
+	int width = fmin(font->height * 16, monitor->window_geometry.width - margin * 2);
+	int height = fmin(font->height * 0.8 * (HUD_FIXED_LINES + hud->kinds_len) + 16,
+			monitor->window_geometry.height - margin * 2);
+
+	wlr_scene_node_set_position(&hud->base.element.scene_tree->node,
+			monitor->window_geometry.x + monitor->window_geometry.width - width - margin,
+			monitor->window_geometry.y + margin);
+
+	hud->base.output = monitor->output;
+	ptychite_window_relay_draw(&hud->base, width, height);
+}
+
+static void hud_clear_flash(struct ptychite_hud *hud) {
+	struct wlr_scene_node *node, *node_tmp;
+	wl_list_for_each_safe(node, node_tmp, &hud->damage.tree->children, link) {
+		struct wlr_scene_buffer *scene_buffer = wlr_scene_buffer_from_node(node);
+		pixman_region32_union_rect(&hud->damage.flashed, &hud->damage.flashed, node->x - 1, node->y - 1,
+				scene_buffer->dst_width + 2, scene_buffer->dst_height + 2);
+		wlr_scene_node_destroy(node);
+	}
+}
+
+static bool hud_flash_accepts_input(struct wlr_scene_buffer *buffer, int sx, int sy) {
+	return false;
+}
+
+static void hud_flash(struct ptychite_hud *hud, pixman_box32_t *rects, int rects_len) {
+	hud_clear_flash(hud);
+
+	int i;
+	for (i = 0; i < rects_len; i++) {
+		struct wlr_scene_buffer *scene_buffer = wlr_scene_buffer_create(hud->damage.tree, hud->damage.tint);
+		if (!scene_buffer) {
+			break;
+		}
+		scene_buffer->point_accepts_input = hud_flash_accepts_input;
+
+		int width = rects[i].x2 - rects[i].x1;
+		int height = rects[i].y2 - rects[i].y1;
+		wlr_scene_node_set_position(&scene_buffer->node, rects[i].x1, rects[i].y1);
+		wlr_scene_buffer_set_dest_size(scene_buffer, width, height);
+		pixman_region32_union_rect(
+				&hud->damage.flashed, &hud->damage.flashed, rects[i].x1 - 1, rects[i].y1 - 1, width + 2, height + 2);
+	}
+
+	wl_event_source_timer_update(hud->damage.timer, HUD_FLASH_MS);
+}
+
+void ptychite_hud_capture_damage(struct ptychite_hud *hud, struct ptychite_monitor *monitor) {
+	struct wlr_scene_node *hud_node = &hud->base.element.scene_tree->node;
+	if ((!hud_node->enabled && !hud->damage.flash) || monitor != monitor->server->active_monitor) {
+		return;
+	}
+
+	if (hud->damage.monitor != monitor) {
+		hud_clear_flash(hud);
+		pixman_region32_clear(&hud->damage.flashed);
+		hud->damage.monitor = monitor;
+	}
+
+	struct wlr_scene_output *scene_output = wlr_scene_get_scene_output(monitor->server->scene, monitor->output);
+	if (!scene_output || !pixman_region32_not_empty(&scene_output->damage_ring.current)) {
+		return;
+	}
+
+	/* the damage ring is in buffer coordinates */
+	struct wlr_output *output = monitor->output;
+	pixman_region32_t damage;
+	pixman_region32_init(&damage);
+	wlr_region_transform(&damage, &scene_output->damage_ring.current, wlr_output_transform_invert(output->transform),
+			output->width, output->height);
+	wlr_region_scale(&damage, &damage, 1.0 / output->scale);
+	pixman_region32_translate(&damage, monitor->geometry.x, monitor->geometry.y);
+
+	/* the hud redrawing and flashes appearing or disappearing would otherwise report and flash themselves */
+	pixman_region32_subtract(&damage, &damage, &hud->damage.flashed);
+	pixman_region32_clear(&hud->damage.flashed);
+	if (hud_node->enabled) {
+		pixman_region32_t hud_region;
+		pixman_region32_init_rect(
+				&hud_region, hud_node->x, hud_node->y, hud->base.element.width, hud->base.element.height);
+		pixman_region32_subtract(&damage, &damage, &hud_region);
+		pixman_region32_fini(&hud_region);
+	}
+
+	int rects_len;
+	pixman_box32_t *rects = pixman_region32_rectangles(&damage, &rects_len);
+	if (!rects_len) {
+		pixman_region32_fini(&damage);
+		return;
+	}
+
+	double area = 0;
+	int i;
+	for (i = 0; i < rects_len; i++) {
+		area += (double)(rects[i].x2 - rects[i].x1) * (rects[i].y2 - rects[i].y1);
+		if (i < PTYCHITE_HUD_DAMAGE_BOXES) {
+			hud->damage.boxes[i] = (struct wlr_box){
+					.x = rects[i].x1,
+					.y = rects[i].y1,
+					.width = rects[i].x2 - rects[i].x1,
+					.height = rects[i].y2 - rects[i].y1,
+			};
+		}
+	}
+	hud->damage.frames++;
+	hud->damage.rects = rects_len;
+	hud->damage.coverage = area / fmax((double)monitor->geometry.width * monitor->geometry.height, 1);
+
+	if (hud->damage.flash) {
+		hud_flash(hud, rects, rects_len);
+	}
+
+	pixman_region32_fini(&damage);
+}
+
+void ptychite_hud_forget_monitor(struct ptychite_hud *hud, struct ptychite_monitor *monitor) {
+	if (hud->damage.monitor == monitor) {
+		hud->damage.monitor = NULL;
+	}
+}
+
+static int hud_handle_damage_timer(void *data) {
+	struct ptychite_hud *hud = data;
+
+	hud_clear_flash(hud);
+
+	return 0;
+}
+
+void ptychite_hud_toggle(struct ptychite_hud *hud) {
+	struct wlr_scene_node *node = &hud->base.element.scene_tree->node;
+
+	if (node->enabled) {
+		wlr_scene_node_set_enabled(node, false);
+	} else {
+		ptychite_hud_draw_auto(hud);
+		wlr_scene_node_set_enabled(node, true);
+	}
+	ptychite_server_invalidate_hit_grids(hud->base.server);
+}
+
+void ptychite_hud_toggle_damage(struct ptychite_hud *hud) {
+	hud->damage.flash = !hud->damage.flash;
+	if (!hud->damage.flash) {
+		wl_event_source_timer_update(hud->damage.timer, 0);
+		hud_clear_flash(hud);
+	}
+
+	if (hud->base.element.scene_tree->node.enabled) {
+		ptychite_window_relay_draw_same_size(&hud->base);
+	}
+}
+
+static struct wlr_buffer *hud_create_tint(const float color[4]) {
+	struct ptychite_buffer *buffer = calloc(1, sizeof(struct ptychite_buffer));
+	if (!buffer) {
+		return NULL;
+	}
+
+	buffer->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+	if (cairo_surface_status(buffer->surface) != CAIRO_STATUS_SUCCESS) {
+		goto err_create_surface;
+	}
+	buffer->cairo = cairo_create(buffer->surface);
+	if (cairo_status(buffer->cairo) != CAIRO_STATUS_SUCCESS) {
+		goto err_create_cairo;
+	}
+
+	cairo_set_source_rgba(buffer->cairo, color[0], color[1], color[2], color[3]);
+	cairo_paint(buffer->cairo);
+	cairo_surface_flush(buffer->surface);
+	wlr_buffer_init(&buffer->base, &ptychite_buffer_buffer_impl, 1, 1);
+
+	return &buffer->base;
+
+err_create_cairo:
+	cairo_destroy(buffer->cairo);
+err_create_surface:
+	cairo_surface_destroy(buffer->surface);
+	free(buffer);
+	return NULL;
+}
+
+int ptychite_hud_init(struct ptychite_hud *hud, struct ptychite_server *server) {
+	pixman_region32_init(&hud->damage.flashed);
+	clock_gettime(CLOCK_MONOTONIC, &hud->last_sample);
+
+	if (ptychite_window_init(&hud->base, server, &ptychite_hud_window_impl, server->layers.overlay, NULL)) {
+		return -1;
+	}
+	wlr_scene_node_set_enabled(&hud->base.element.scene_tree->node, false);
+
+	if (!(hud->damage.tree = wlr_scene_tree_create(server->layers.overlay))) {
+		return -1;
+	}
+
+	if (!(hud->damage.tint = hud_create_tint(hud_damage_tint))) {
+		return -1;
+	}
+
+	if (!(hud->damage.timer =
+						wl_event_loop_add_timer(wl_display_get_event_loop(server->display), hud_handle_damage_timer, hud))) {
+		return -1;
+	}
+
+	return 0;
+}
+
+void ptychite_hud_finish(struct ptychite_hud *hud) {
+	wl_event_source_remove(hud->damage.timer);
+	wlr_buffer_drop(hud->damage.tint);
+	pixman_region32_fini(&hud->damage.flashed);
+}
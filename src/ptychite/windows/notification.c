@@ -115,6 +115,7 @@ static void notification_handle_pointer_button(
 }
 
 const struct ptychite_window_impl ptychite_notification_window_impl = {
+		.name = "notification",
 		.draw = notification_draw,
 		.handle_pointer_enter = NULL,
 		.handle_pointer_leave = notification_handle_pointer_leave,
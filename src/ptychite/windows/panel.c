@@ -636,6 +636,7 @@ static void panel_destroy(struct ptychite_window *window) {
 }
 
 const struct ptychite_window_impl ptychite_panel_window_impl = {
+		.name = "panel",
 		.draw = panel_draw,
 		.handle_pointer_enter = panel_handle_pointer_enter,
 		.handle_pointer_leave = panel_handle_pointer_leave,
@@ -34,7 +34,7 @@ static void switcher_draw(
 
 	struct ptychite_switcher_app *sapp;
 	wl_list_for_each(sapp, &switcher->sapps, link) {
-		struct ptychite_icon *icon = ptychite_hash_map_get(&server->icons, sapp->app->resolved_icon);
+		struct ptychite_icon *icon = sapp->icon;
 		if (!icon) {
 			continue;
 		}
@@ -62,6 +62,7 @@ static void switcher_draw(
 }
 
 const struct ptychite_window_impl ptychite_switcher_window_impl = {
+		.name = "switcher",
 		.draw = switcher_draw,
 		.handle_pointer_enter = NULL,
 		.handle_pointer_leave = NULL,
@@ -104,6 +105,7 @@ static void sub_switcher_draw(
 }
 
 const struct ptychite_window_impl ptychite_sub_switcher_window_impl = {
+		.name = "sub switcher",
 		.draw = sub_switcher_draw,
 		.handle_pointer_enter = NULL,
 		.handle_pointer_leave = NULL,
@@ -132,7 +134,7 @@ void ptychite_switcher_draw_auto(struct ptychite_switcher *switcher, bool sub_sw
 
 	struct ptychite_view *view;
 	wl_list_for_each(view, &server->views, server_link) {
-		struct ptychite_application *app = ptychite_hash_map_get(&server->applications, view->xdg_toplevel->app_id);
+		struct ptychite_application *app = view->application;
 		if (!app) {
 			view->in_switcher = false;
 			continue;
@@ -182,6 +184,7 @@ void ptychite_switcher_draw_auto(struct ptychite_switcher *switcher, bool sub_sw
 		wl_list_insert(switcher->sapps.prev, &sapp->link);
 
 		sapp->app = app;
+		sapp->icon = view->icon;
 
 		wl_list_init(&sapp->views);
 		wl_list_insert(&sapp->views, &view->switcher_link);
@@ -252,4 +255,6 @@ void ptychite_switcher_draw_auto(struct ptychite_switcher *switcher, bool sub_sw
 	} else {
 		wlr_scene_node_set_enabled(&switcher->sub_switcher.element.scene_tree->node, false);
 	}
+
+	ptychite_server_invalidate_hit_grids(server);
 }
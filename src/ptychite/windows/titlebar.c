@@ -106,6 +106,7 @@ static void title_bar_destroy(struct ptychite_window *window) {
 }
 
 const struct ptychite_window_impl ptychite_title_bar_window_impl = {
+		.name = "title bar",
 		.draw = title_bar_draw,
 		.handle_pointer_enter = title_bar_handle_pointer_enter,
 		.handle_pointer_leave = title_bar_handle_pointer_leave,
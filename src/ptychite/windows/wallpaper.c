@@ -50,6 +50,7 @@ static void wallpaper_destroy(struct ptychite_window *window) {
 }
 
 const struct ptychite_window_impl ptychite_wallpaper_window_impl = {
+		.name = "wallpaper",
 		.draw = wallpaper_draw,
 		.handle_pointer_enter = NULL,
 		.handle_pointer_leave = NULL,
@@ -102,7 +102,8 @@ static void registry_handle_global(
 	struct ptymsg_state *state = data;
 
 	if (!strcmp(interface, zptychite_message_v1_interface.name)) {
-		state->ptychite_message = wl_registry_bind(registry, name, &zptychite_message_v1_interface, 1);
+		state->ptychite_message =
+				wl_registry_bind(registry, name, &zptychite_message_v1_interface, version < 4 ? version : 4);
 	} else if (!strcmp(interface, wl_output_interface.name)) {
 		struct monitor *monitor = calloc(1, sizeof(struct monitor));
 		if (!monitor) {
@@ -264,6 +265,66 @@ int main(int argc, char **argv) {
 			}
 			callback = zptychite_message_v1_dump_views(state.ptychite_message, output, mode);
 			callback_data->error_prefix = "failed to dump view info";
+
+		} else if (!strcmp(argv[i], "dump-launch-stats")) {
+			enum zptychite_message_v1_json_get_mode mode = ZPTYCHITE_MESSAGE_V1_JSON_GET_MODE_PRETTY;
+			if (i + 1 < argc && !strcmp(argv[i + 1], "--compact")) {
+				mode = ZPTYCHITE_MESSAGE_V1_JSON_GET_MODE_COMPACT;
+				i++;
+			}
+			if (zptychite_message_v1_get_version(state.ptychite_message) < 2) {
+				fprintf(stderr, "command dump-launch-stats is not supported by the compositor\n");
+				state.exit_code = 1;
+				goto done;
+			}
+			callback = zptychite_message_v1_dump_launch_stats(state.ptychite_message, mode);
+			callback_data->error_prefix = "failed to dump launch stats";
+
+		} else if (!strcmp(argv[i], "dump-latency")) {
+			enum zptychite_message_v1_json_get_mode mode = ZPTYCHITE_MESSAGE_V1_JSON_GET_MODE_PRETTY;
+			if (i + 1 < argc && !strcmp(argv[i + 1], "--compact")) {
+				mode = ZPTYCHITE_MESSAGE_V1_JSON_GET_MODE_COMPACT;
+				i++;
+			}
+			if (zptychite_message_v1_get_version(state.ptychite_message) < 3) {
+				fprintf(stderr, "command dump-latency is not supported by the compositor\n");
+				state.exit_code = 1;
+				goto done;
+			}
+			callback = zptychite_message_v1_dump_latency(state.ptychite_message, mode);
+			callback_data->error_prefix = "failed to dump latency";
+
+		} else if (!strcmp(argv[i], "stats")) {
+			if (i + 1 >= argc || strcmp(argv[i + 1], "frames")) {
+				fprintf(stderr, "command stats requires the argument 'frames'\n");
+				state.exit_code = 1;
+				goto done;
+			}
+			i++;
+			enum zptychite_message_v1_json_get_mode mode = ZPTYCHITE_MESSAGE_V1_JSON_GET_MODE_PRETTY;
+			if (i + 1 < argc && !strcmp(argv[i + 1], "--compact")) {
+				mode = ZPTYCHITE_MESSAGE_V1_JSON_GET_MODE_COMPACT;
+				i++;
+			}
+			if (zptychite_message_v1_get_version(state.ptychite_message) < 4) {
+				fprintf(stderr, "command stats frames is not supported by the compositor\n");
+				state.exit_code = 1;
+				goto done;
+			}
+			/* the output is optional, so the next argument only counts as one if an output has that name */
+			struct wl_output *output = NULL;
+			if (i + 1 < argc) {
+				struct monitor *monitor;
+				wl_list_for_each(monitor, &state.monitors, link) {
+					if (!strcmp(monitor->name, argv[i + 1])) {
+						output = monitor->output;
+						i++;
+						break;
+					}
+				}
+			}
+			callback = zptychite_message_v1_dump_frame_stats(state.ptychite_message, output, mode);
+			callback_data->error_prefix = "failed to dump frame stats";
 		}
 
 		if (callback) {